@@ -306,6 +306,8 @@ void Adafruit_ILI9341::setAddrWindow(uint16_t x1, uint16_t y1, uint16_t w,
   static uint16_t old_y1 = 0xffff, old_y2 = 0xffff;
 
   uint16_t x2 = (x1 + w - 1), y2 = (y1 + h - 1);
+  PICOCALC_BUS_WINDOW(x1 != old_x1 || x2 != old_x2, y1 != old_y1 || y2 != old_y2,
+                      w, h);
   if (x1 != old_x1 || x2 != old_x2) {
     writeCommand(ILI9341_CASET); // Column address set
     SPI_WRITE16(x1);
@@ -336,5 +338,57 @@ void Adafruit_ILI9341::setAddrWindow(uint16_t x1, uint16_t y1, uint16_t w,
 uint8_t Adafruit_ILI9341::readcommand8(uint8_t commandByte, uint8_t index) {
   uint8_t data = 0x10 + index;
   sendCommand(0xD9, &data, 1); // Set Index Register
-  return Adafruit_SPITFT::readcommand8(commandByte);
+  // Opens its own transaction like sendCommand(), so it is timed the same way.
+  PICOCALC_BUS_BEGIN();
+  PICOCALC_BUS_COMMAND(commandByte, 1);
+  uint8_t result = Adafruit_SPITFT::readcommand8(commandByte);
+  PICOCALC_BUS_END();
+  return result;
 }
+
+#ifdef USE_PICOCALC_BUS_STATS
+/**************************************************************************/
+/*!
+    @brief  Open an SPI transaction and start timing it for the bus
+            statistics. Nested calls are only counted once.
+*/
+/**************************************************************************/
+void Adafruit_ILI9341::startWrite(void) {
+  PICOCALC_BUS_BEGIN();
+  Adafruit_SPITFT::startWrite();
+}
+
+/**************************************************************************/
+/*!
+    @brief  Close an SPI transaction and add its duration to the current
+            frame of the bus statistics.
+*/
+/**************************************************************************/
+void Adafruit_ILI9341::endWrite(void) {
+  Adafruit_SPITFT::endWrite();
+  PICOCALC_BUS_END();
+}
+
+/**************************************************************************/
+/*!
+    @brief  Send a command with its own transaction, counting it and its
+            bus time in the bus statistics. Hides Adafruit_SPITFT's version,
+            so every sendCommand() made through this class is counted.
+    @param  commandByte   The command byte
+    @param  dataBytes     Parameters following the command, or NULL
+    @param  numDataBytes  Number of parameter bytes
+*/
+/**************************************************************************/
+void Adafruit_ILI9341::sendCommand(uint8_t commandByte, const uint8_t *dataBytes,
+                                   uint8_t numDataBytes) {
+  PICOCALC_BUS_BEGIN();
+  PICOCALC_BUS_COMMAND(commandByte, numDataBytes);
+  Adafruit_SPITFT::sendCommand(commandByte, dataBytes, numDataBytes);
+  PICOCALC_BUS_END();
+}
+
+void Adafruit_ILI9341::sendCommand(uint8_t commandByte, uint8_t *dataBytes,
+                                   uint8_t numDataBytes) {
+  sendCommand(commandByte, (const uint8_t *)dataBytes, numDataBytes);
+}
+#endif // USE_PICOCALC_BUS_STATS
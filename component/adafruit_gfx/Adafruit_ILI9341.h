@@ -42,6 +42,8 @@
 #include <Adafruit_SPITFT.h>
 #include <SPI.h>
 
+#include "esphome/components/picocalc/bus_stats.h"
+
 #define ILI9341_TFTWIDTH 320  ///< ILI9341 max TFT width
 #define ILI9341_TFTHEIGHT 320 ///< ILI9341 max TFT height
 
@@ -151,6 +153,14 @@ public:
 
   // Transaction API not used by GFX
   void setAddrWindow(uint16_t x, uint16_t y, uint16_t w, uint16_t h);
+#ifdef USE_PICOCALC_BUS_STATS
+  void startWrite(void) override;
+  void endWrite(void) override;
+  void sendCommand(uint8_t commandByte, uint8_t *dataBytes,
+                   uint8_t numDataBytes);
+  void sendCommand(uint8_t commandByte, const uint8_t *dataBytes = NULL,
+                   uint8_t numDataBytes = 0);
+#endif
 
   uint8_t readcommand8(uint8_t reg, uint8_t index = 0);
 };
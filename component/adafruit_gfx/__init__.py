@@ -1,17 +1,140 @@
 import esphome.codegen as cg
 import esphome.config_validation as cv
-from esphome.const import CONF_ID
+from esphome.components import sensor
+from esphome.const import (
+    CONF_FILE,
+    CONF_GLYPHS,
+    CONF_ID,
+    CONF_RAW_DATA_ID,
+    CONF_SIZE,
+    ENTITY_CATEGORY_DIAGNOSTIC,
+    STATE_CLASS_MEASUREMENT,
+)
+from esphome.core import CORE, EsphomeError
+from esphome.components.picocalc import CONF_PICOCALC_ID, Panel, PicoCalc
+
+DEPENDENCIES = ["picocalc"]
+
+CONF_FONT = "font"
+CONF_RAW_GLYPH_ID = "raw_glyph_id"
+CONF_BUILTIN_GLYPH_RATE = "builtin_glyph_rate"
+CONF_AA_GLYPH_RATE = "aa_glyph_rate"
+CONF_KEEP_AWAKE = "keep_awake"
+UNIT_GLYPHS_PER_SECOND = "glyphs/s"
 
 picocalc_ns = cg.esphome_ns.namespace("picocalc")
 AdafruitGfx = picocalc_ns.class_(
-    "AdafruitGfx", cg.Component
+    "AdafruitGfx", cg.Component, cg.Parented.template(PicoCalc), Panel
+)
+AaFont = picocalc_ns.class_("AaFont")
+AaGlyph = picocalc_ns.struct("AaGlyph")
+
+# Rasterized at build time into 4bpp coverage, drawn by AaTextRenderer.
+FONT_SCHEMA = cv.Schema(
+    {
+        cv.GenerateID(): cv.declare_id(AaFont),
+        cv.Required(CONF_FILE): cv.file_,
+        cv.Optional(CONF_SIZE, default=16): cv.int_range(min=6, max=64),
+        cv.Optional(CONF_GLYPHS, default=["".join(chr(c) for c in range(0x20, 0x7F))]): cv.ensure_list(
+            cv.string_strict
+        ),
+        cv.GenerateID(CONF_RAW_DATA_ID): cv.declare_id(cg.uint8),
+        cv.GenerateID(CONF_RAW_GLYPH_ID): cv.declare_id(AaGlyph),
+    }
 )
 
+
+def _glyph_rate_sensor():
+    return sensor.sensor_schema(
+        unit_of_measurement=UNIT_GLYPHS_PER_SECOND,
+        accuracy_decimals=0,
+        state_class=STATE_CLASS_MEASUREMENT,
+        entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+    )
+
+
 CONFIG_SCHEMA = (
-    cv.Schema({cv.GenerateID(): cv.declare_id(AdafruitGfx)})
+    cv.Schema(
+        {
+            cv.GenerateID(): cv.declare_id(AdafruitGfx),
+            cv.GenerateID(CONF_PICOCALC_ID): cv.use_id(PicoCalc),
+            cv.Optional(CONF_FONT): FONT_SCHEMA,
+            # Published by the text benchmark in the demo cycle; needs font.
+            cv.Optional(CONF_BUILTIN_GLYPH_RATE): _glyph_rate_sensor(),
+            cv.Optional(CONF_AA_GLYPH_RATE): _glyph_rate_sensor(),
+            # Count every demo redraw as activity, so picocalc's idle manager never dims the panel.
+            cv.Optional(CONF_KEEP_AWAKE, default=False): cv.boolean,
+        }
+    )
     .extend(cv.COMPONENT_SCHEMA)
 )
 
+
+def _pack_nibbles(levels):
+    if len(levels) % 2:
+        levels = levels + [0]
+    return [(levels[i] << 4) | levels[i + 1] for i in range(0, len(levels), 2)]
+
+
+def _rasterize(path, size, codepoints):
+    import freetype
+
+    face = freetype.Face(path)
+    face.set_pixel_sizes(0, size)
+    ascent = (face.size.ascender + 63) >> 6
+    line_height = (face.size.height + 63) >> 6
+    atlas = []
+    glyphs = []
+    for codepoint in codepoints:
+        if face.get_char_index(codepoint) == 0:
+            raise EsphomeError(f"{path} has no glyph for U+{codepoint:04X}")
+        face.load_char(chr(codepoint), freetype.FT_LOAD_RENDER | freetype.FT_LOAD_TARGET_LIGHT)
+        slot = face.glyph
+        bitmap = slot.bitmap
+        if bitmap.width > 255 or bitmap.rows > 255:
+            raise EsphomeError(f"Glyph U+{codepoint:04X} of {path} is too large")
+        levels = [
+            (bitmap.buffer[row * bitmap.pitch + col] * 15 + 127) // 255
+            for row in range(bitmap.rows)
+            for col in range(bitmap.width)
+        ]
+        glyphs.append(
+            (
+                codepoint,
+                len(atlas),
+                bitmap.width,
+                bitmap.rows,
+                slot.bitmap_left,
+                -slot.bitmap_top,
+                (slot.advance.x + 32) >> 6,
+            )
+        )
+        atlas += _pack_nibbles(levels)
+    return atlas, glyphs, line_height, ascent
+
+
 async def to_code(config):
     var = cg.new_Pvariable(config[CONF_ID])
-    await cg.register_component(var, config)
\ No newline at end of file
+    await cg.register_component(var, config)
+    await cg.register_parented(var, config[CONF_PICOCALC_ID])
+    parent = await cg.get_variable(config[CONF_PICOCALC_ID])
+    # Takes over from a display_id panel configured on picocalc.
+    cg.add(parent.set_panel(var))
+    cg.add(var.set_keep_awake(config[CONF_KEEP_AWAKE]))
+    # adafruit_gfx.h pulls in FreeRTOS.h, which makes arduino-pico run the loop as a task.
+    cg.add_define("USE_PICOCALC_FREERTOS")
+
+    if font_config := config.get(CONF_FONT):
+        codepoints = sorted({ord(c) for text in font_config[CONF_GLYPHS] for c in text})
+        path = str(CORE.relative_config_path(font_config[CONF_FILE]))
+        atlas, glyphs, line_height, ascent = _rasterize(path, font_config[CONF_SIZE], codepoints)
+        atlas_var = cg.progmem_array(font_config[CONF_RAW_DATA_ID], atlas)
+        glyph_var = cg.static_const_array(font_config[CONF_RAW_GLYPH_ID], glyphs)
+        font = cg.new_Pvariable(font_config[CONF_ID], atlas_var, glyph_var, len(glyphs), line_height, ascent)
+        cg.add_define("PICOCALC_AA_MAX_GLYPH_WIDTH", max([1] + [glyph[2] for glyph in glyphs]))
+        cg.add(var.set_font(font))
+
+    for key in (CONF_BUILTIN_GLYPH_RATE, CONF_AA_GLYPH_RATE):
+        if key in config:
+            sens = await sensor.new_sensor(config[key])
+            cg.add(getattr(var, f"set_{key}_sensor")(sens))
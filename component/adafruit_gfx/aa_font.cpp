@@ -0,0 +1,119 @@
+#include "aa_font.h"
+
+namespace esphome
+{
+    namespace picocalc
+    {
+        const AaGlyph *AaFont::find(uint32_t codepoint) const
+        {
+            int32_t low = 0;
+            int32_t high = int32_t(this->glyph_count_) - 1;
+            while (low <= high)
+            {
+                int32_t mid = (low + high) / 2;
+                uint32_t found = this->glyphs_[mid].codepoint;
+                if (found == codepoint)
+                    return &this->glyphs_[mid];
+                if (found < codepoint)
+                    low = mid + 1;
+                else
+                    high = mid - 1;
+            }
+            return nullptr;
+        }
+
+        void AaTextRenderer::set_colors(uint16_t foreground, uint16_t background)
+        {
+            if (this->palette_valid_ && foreground == this->foreground_ && background == this->background_)
+                return;
+            this->foreground_ = foreground;
+            this->background_ = background;
+            // Blend per channel in RGB565 so the palette needs no colour conversion.
+            int32_t fr = foreground >> 11, fg = (foreground >> 5) & 0x3F, fb = foreground & 0x1F;
+            int32_t br = background >> 11, bg = (background >> 5) & 0x3F, bb = background & 0x1F;
+            for (int32_t a = 0; a < 16; a++)
+            {
+                int32_t r = br + ((fr - br) * a + 7) / 15;
+                int32_t g = bg + ((fg - bg) * a + 7) / 15;
+                int32_t b = bb + ((fb - bb) * a + 7) / 15;
+                this->palette_[a] = uint16_t((r << 11) | (g << 5) | b);
+            }
+            this->palette_valid_ = true;
+        }
+
+        int16_t AaTextRenderer::draw_glyph(Adafruit_SPITFT &tft, int16_t x, int16_t y, uint32_t codepoint)
+        {
+            if (this->font_ == nullptr)
+                return x;
+            const AaGlyph *glyph = this->font_->find(codepoint);
+            if (glyph == nullptr)
+                glyph = this->font_->find('?');
+            if (glyph == nullptr)
+                return x;
+            if (!this->palette_valid_)
+                this->set_colors(this->foreground_, this->background_);
+
+            int16_t left = x + glyph->x_offset;
+            int16_t top = y + this->font_->ascent() + glyph->y_offset;
+            int16_t x0 = left < 0 ? 0 : left;
+            int16_t y0 = top < 0 ? 0 : top;
+            int16_t x1 = left + glyph->width;
+            int16_t y1 = top + glyph->height;
+            if (x1 > tft.width())
+                x1 = tft.width();
+            if (y1 > tft.height())
+                y1 = tft.height();
+            if (x1 - x0 > PICOCALC_AA_MAX_GLYPH_WIDTH)
+                x1 = x0 + PICOCALC_AA_MAX_GLYPH_WIDTH;
+            if (x0 < x1 && y0 < y1)
+            {
+                const uint8_t *atlas = this->font_->atlas() + glyph->offset;
+                uint16_t width = x1 - x0;
+                tft.startWrite();
+                tft.setAddrWindow(x0, y0, width, y1 - y0);
+                for (int16_t row = y0; row < y1; row++)
+                {
+                    uint32_t nibble = uint32_t(row - top) * glyph->width + (x0 - left);
+                    for (uint16_t col = 0; col < width; col++, nibble++)
+                    {
+                        uint8_t packed = atlas[nibble >> 1];
+                        this->row_[col] = this->palette_[(nibble & 1) ? (packed & 0x0F) : (packed >> 4)];
+                    }
+                    tft.writePixels(this->row_, width, true, false);
+                }
+                tft.endWrite();
+                this->glyphs_drawn_++;
+            }
+            return x + glyph->advance;
+        }
+
+        int16_t AaTextRenderer::draw_text(Adafruit_SPITFT &tft, int16_t x, int16_t y, const char *text)
+        {
+            const uint8_t *p = reinterpret_cast<const uint8_t *>(text);
+            while (*p != 0)
+            {
+                uint32_t codepoint = *p++;
+                uint8_t continuation = 0;
+                if (codepoint >= 0xF0)
+                {
+                    codepoint &= 0x07;
+                    continuation = 3;
+                }
+                else if (codepoint >= 0xE0)
+                {
+                    codepoint &= 0x0F;
+                    continuation = 2;
+                }
+                else if (codepoint >= 0xC0)
+                {
+                    codepoint &= 0x1F;
+                    continuation = 1;
+                }
+                for (; continuation > 0 && (*p & 0xC0) == 0x80; continuation--)
+                    codepoint = (codepoint << 6) | (*p++ & 0x3F);
+                x = this->draw_glyph(tft, x, y, codepoint);
+            }
+            return x;
+        }
+    } // namespace picocalc
+} // namespace esphome
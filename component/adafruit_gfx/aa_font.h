@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "esphome/core/defines.h"
+#include "Adafruit_SPITFT.h"
+
+#ifndef PICOCALC_AA_MAX_GLYPH_WIDTH
+#define PICOCALC_AA_MAX_GLYPH_WIDTH 64
+#endif
+
+namespace esphome {
+namespace picocalc {
+
+// One glyph of an AaFont. The coverage bitmap starts at byte `offset` of the
+// atlas: width * height 4-bit values, row by row, high nibble first.
+struct AaGlyph {
+    uint32_t codepoint;
+    uint32_t offset;
+    uint8_t width;
+    uint8_t height;
+    // From the pen position on the baseline to the top left of the bitmap.
+    int8_t x_offset;
+    int8_t y_offset;
+    uint8_t advance;
+};
+
+// A TTF rasterized at build time by the adafruit_gfx font: config. Glyphs are
+// sorted by codepoint; atlas and glyph table live in flash.
+class AaFont {
+    public:
+        AaFont(const uint8_t *atlas, const AaGlyph *glyphs, uint16_t glyph_count, uint8_t line_height, uint8_t ascent)
+            : atlas_(atlas), glyphs_(glyphs), glyph_count_(glyph_count), line_height_(line_height), ascent_(ascent) {}
+
+        // nullptr for codepoints that were not rasterized.
+        const AaGlyph *find(uint32_t codepoint) const;
+        const uint8_t *atlas() const { return this->atlas_; }
+        uint16_t glyph_count() const { return this->glyph_count_; }
+        uint8_t line_height() const { return this->line_height_; }
+        // Pixels from the top of a line to its baseline.
+        uint8_t ascent() const { return this->ascent_; }
+
+    protected:
+        const uint8_t *atlas_;
+        const AaGlyph *glyphs_;
+        uint16_t glyph_count_;
+        uint8_t line_height_;
+        uint8_t ascent_;
+};
+
+// Draws AaFont text without reading the panel back: coverage is blended
+// against the background colour the caller says is there, through a
+// 16-entry RGB565 palette. Each glyph goes out as one address window and
+// one RAMWR burst; pixels outside the glyph box are left alone.
+class AaTextRenderer {
+    public:
+        void set_font(const AaFont *font) { this->font_ = font; }
+        const AaFont *font() const { return this->font_; }
+        void set_colors(uint16_t foreground, uint16_t background);
+
+        // y is the top of the line. Returns the pen x after the glyph.
+        int16_t draw_glyph(Adafruit_SPITFT &tft, int16_t x, int16_t y, uint32_t codepoint);
+        // UTF-8 text on one line; returns the pen x after the last glyph.
+        int16_t draw_text(Adafruit_SPITFT &tft, int16_t x, int16_t y, const char *text);
+        uint32_t glyphs_drawn() const { return this->glyphs_drawn_; }
+        // The blended colour palette and the one-row strip each glyph goes out through.
+        static constexpr size_t palette_size() { return sizeof(AaTextRenderer::palette_); }
+        static constexpr size_t strip_size() { return sizeof(AaTextRenderer::row_); }
+
+    protected:
+        const AaFont *font_{nullptr};
+        uint16_t foreground_{0xFFFF};
+        uint16_t background_{0x0000};
+        uint16_t palette_[16];
+        bool palette_valid_{false};
+        uint32_t glyphs_drawn_{0};
+        uint16_t row_[PICOCALC_AA_MAX_GLYPH_WIDTH];
+};
+
+}  // namespace picocalc
+}  // namespace esphome
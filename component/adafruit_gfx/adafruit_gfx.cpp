@@ -24,6 +24,7 @@ namespace esphome
     namespace picocalc
     {
         static const char *const TAG = "adafruit_gfx";
+        static const char *const BENCHMARK_TEXT = "The quick brown fox jumps over the lazy dog 0123456789";
         uint8_t x = 0;
     
         void AdafruitGfx::setup()
@@ -33,9 +34,25 @@ namespace esphome
             tft.setRotation(ORIENTATION);
             tft.fillScreen(ILI9341_BLACK);
             tft.invertDisplay(true);
+            this->set_initial_state(0x48, true);  // MADCTL_MX | MADCTL_BGR from setRotation(0)
 
             // read diagnostics (optional but can help debug problems)
             uint8_t x = tft.readcommand8(ILI9341_RDMODE);
+
+#ifdef USE_PICOCALC_LOOP_TRACE
+            this->tracer_ = this->parent_->get_loop_tracer();
+            if (this->tracer_ != nullptr)
+                this->trace_slot_ = this->tracer_->register_slot("adafruit_gfx");
+#endif
+            MemoryMonitor *memory = this->parent_->get_memory_monitor();
+            if (memory != nullptr)
+            {
+                // Both live inside the component, so they are held from boot.
+                memory->set_used(memory->register_budget("aa_palette", AaTextRenderer::palette_size()),
+                                 AaTextRenderer::palette_size());
+                memory->set_used(memory->register_budget("aa_glyph_strip", AaTextRenderer::strip_size()),
+                                 AaTextRenderer::strip_size());
+            }
         }
 
 
@@ -51,11 +68,22 @@ namespace esphome
             ESP_LOGCONFIG(TAG, "Image Format: %X", x);
             x = tft.readcommand8(ILI9341_RDSELFDIAG);
             ESP_LOGCONFIG(TAG, "Self Diagnostic: %X", x);
+            const AaFont *font = this->text_.font();
+            if (font != nullptr)
+                ESP_LOGCONFIG(TAG, "AA font: %u glyphs, %u px line height", (unsigned) font->glyph_count(),
+                              (unsigned) font->line_height());
+            LOG_SENSOR("  ", "Built-in glyph rate", this->builtin_glyph_rate_sensor_);
+            LOG_SENSOR("  ", "AA glyph rate", this->aa_glyph_rate_sensor_);
+            ESP_LOGCONFIG(TAG, "Keep awake: %s", YESNO(this->keep_awake_));
         }
 
         int cycle = 0;
         void AdafruitGfx::loop()
         {
+            LoopTraceScope trace(this->tracer_, this->trace_slot_);
+            HeapProbeScope heap_probe(this->parent_->get_render_heap_probe());
+            if (this->keep_awake_)
+                this->parent_->notify_activity();
             switch (cycle)
             {
                 case 0: tft.fillScreen(ILI9341_BLACK); break;
@@ -73,13 +101,79 @@ namespace esphome
                 case 12: testFilledTriangles(); break;
                 case 13: testRoundRects(); break;
                 case 14: testFilledRoundRects(); break;
+                case 15: this->benchmark_text_(); break;
                 default: cycle = 0; break;
             }
             
             cycle++;
+            PICOCALC_BUS_FRAME();
             return;
         }
 
+        // Fills the screen with the same text in the built-in font, scaled to
+        // about the same height, and in the AA font. Only characters that fit
+        // on a line are drawn and counted, spaces included.
+        void AdafruitGfx::benchmark_text_()
+        {
+            const AaFont *font = this->text_.font();
+            if (font == nullptr)
+                return;
+            uint8_t line_height = font->line_height();
+            uint8_t size = (line_height + 4) / 8;
+            if (size == 0)
+                size = 1;
+
+            tft.fillScreen(ILI9341_BLACK);
+            uint32_t builtin_glyphs = 0;
+            uint32_t start = micros();
+            tft.setTextWrap(false);
+            tft.setTextSize(size);
+            tft.setTextColor(ILI9341_WHITE, ILI9341_BLACK);
+            for (int16_t y = 0; y + 8 * size <= tft.height(); y += 8 * size)
+            {
+                tft.setCursor(0, y);
+                for (const char *c = BENCHMARK_TEXT; *c != 0 && tft.getCursorX() + 6 * size <= tft.width(); c++)
+                {
+                    tft.write(*c);
+                    builtin_glyphs++;
+                }
+            }
+            uint32_t builtin_us = micros() - start;
+
+            App.feed_wdt();
+            tft.fillScreen(ILI9341_BLACK);
+            this->text_.set_colors(ILI9341_WHITE, ILI9341_BLACK);
+            uint32_t aa_glyphs = 0;
+            start = micros();
+            for (int16_t y = 0; y + line_height <= tft.height(); y += line_height)
+            {
+                int16_t x = 0;
+                for (const char *c = BENCHMARK_TEXT; *c != 0; c++)
+                {
+                    const AaGlyph *glyph = font->find(*c);
+                    if (glyph == nullptr || x + glyph->advance > tft.width())
+                        break;
+                    x = this->text_.draw_glyph(tft, x, y, *c);
+                    aa_glyphs++;
+                }
+            }
+            uint32_t aa_us = micros() - start;
+
+            float builtin_rate = builtin_glyphs * 1e6f / builtin_us;
+            float aa_rate = aa_glyphs * 1e6f / aa_us;
+            ESP_LOGI(TAG, "Text: built-in %.0f glyphs/s (size %u), AA %.0f glyphs/s (%u px)", builtin_rate,
+                     (unsigned) size, aa_rate, (unsigned) line_height);
+            if (this->builtin_glyph_rate_sensor_ != nullptr)
+                this->builtin_glyph_rate_sensor_->publish_state(builtin_rate);
+            if (this->aa_glyph_rate_sensor_ != nullptr)
+                this->aa_glyph_rate_sensor_->publish_state(aa_rate);
+        }
+
+        void AdafruitGfx::send_command(uint8_t command, const uint8_t *data, uint8_t length)
+        {
+            tft.sendCommand(command, data, length);
+        }
+
         void AdafruitGfx::delay(uint32_t ms)
         {
             App.feed_wdt();
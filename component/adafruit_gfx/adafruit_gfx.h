@@ -4,19 +4,39 @@
 #include <task.h>
 
 #include "esphome/core/component.h"
+#include "esphome/core/helpers.h"
+#include "esphome/components/picocalc/picocalc.h"
 
+#include "aa_font.h"
 #include "gfxtest.h"
 
 namespace esphome {
 namespace picocalc {
 
-class AdafruitGfx : public Component {
+class AdafruitGfx : public Component, public Parented<PicoCalc>, public Panel {
     public:
         void setup() override;
         void dump_config() override;
         void loop() override;
+
+        void send_command(uint8_t command, const uint8_t *data, uint8_t length) override;
+        // The anti-aliased font used by the demo cycle; also usable from lambdas.
+        void set_font(const AaFont *font) { this->text_.set_font(font); }
+        AaTextRenderer &get_text_renderer() { return this->text_; }
+        void set_builtin_glyph_rate_sensor(sensor::Sensor *sensor) { this->builtin_glyph_rate_sensor_ = sensor; }
+        void set_aa_glyph_rate_sensor(sensor::Sensor *sensor) { this->aa_glyph_rate_sensor_ = sensor; }
+        void set_keep_awake(bool keep_awake) { this->keep_awake_ = keep_awake; }
     protected:
         void delay(uint32_t ms);
+        void benchmark_text_();
+
+        AaTextRenderer text_;
+        sensor::Sensor *builtin_glyph_rate_sensor_{nullptr};
+        sensor::Sensor *aa_glyph_rate_sensor_{nullptr};
+        bool keep_awake_{false};
+
+        LoopTracer *tracer_{nullptr};
+        uint8_t trace_slot_{LOOP_TRACE_NO_SLOT};
 };
 
 }  // namespace picocalc
@@ -1,17 +1,593 @@
+from esphome import automation
 import esphome.codegen as cg
 import esphome.config_validation as cv
-from esphome.const import CONF_ID
+from esphome.components import i2c, sensor
+from esphome.components.logger import LOG_LEVELS, is_log_level
+from esphome.core import CORE
+from esphome.const import (
+    CONF_DISPLAY_ID,
+    CONF_ID,
+    CONF_LEVEL,
+    CONF_NAME,
+    CONF_PORT,
+    CONF_ENABLED,
+    CONF_FREQUENCY,
+    CONF_TIMEOUT,
+    CONF_TRIGGER_ID,
+    CONF_UPDATE_INTERVAL,
+    ENTITY_CATEGORY_DIAGNOSTIC,
+    STATE_CLASS_MEASUREMENT,
+    STATE_CLASS_TOTAL_INCREASING,
+    UNIT_BYTES,
+    UNIT_MICROSECOND,
+    UNIT_MILLISECOND,
+    UNIT_PERCENT,
+)
+
+CONF_PICOCALC_ID = "picocalc_id"
+
+
+def AUTO_LOAD():
+    # socket is only needed by the screen mirror.
+    config = (CORE.raw_config or {}).get("picocalc")
+    if isinstance(config, dict) and CONF_MIRROR in config:
+        return ["sensor", "socket"]
+    return ["sensor"]
+
+
+CONF_BUS_STATS = "bus_stats"
+CONF_COMMANDS = "commands"
+CONF_DATA_BYTES = "data_bytes"
+CONF_WINDOWS = "windows"
+CONF_CS_TOGGLES = "cs_toggles"
+CONF_BUSY_TIME = "busy_time"
+CONF_LOOP_TRACE = "loop_trace"
+CONF_PASS_START_ID = "pass_start_id"
+CONF_PASS_END_ID = "pass_end_id"
+CONF_SLOW_THRESHOLD = "slow_threshold"
+CONF_LOOP_TIME_P99 = "loop_time_p99"
+CONF_LOOP_TIME_MAX = "loop_time_max"
+CONF_SLOW_CALLS = "slow_calls"
+CONF_MEMORY = "memory"
+CONF_BUDGETS = "budgets"
+CONF_LIMIT = "limit"
+CONF_FREE_HEAP = "free_heap"
+CONF_LARGEST_FREE_BLOCK = "largest_free_block"
+CONF_STACK_HIGH_WATER = "stack_high_water"
+CONF_DISPLAY_MEMORY = "display_memory"
+CONF_ALLOCATORS = "allocators"
+CONF_FRAME_ARENA_SIZE = "frame_arena_size"
+CONF_LABEL_SLOTS = "label_slots"
+CONF_ARENA_HIGH_WATER = "arena_high_water"
+CONF_POOL_IN_USE = "pool_in_use"
+CONF_ALLOC_FAILURES = "alloc_failures"
+CONF_RENDER_HEAP_ALLOCATIONS = "render_heap_allocations"
+CONF_UPDATE_QUEUE = "update_queue"
+CONF_UPDATES_ENQUEUED = "updates_enqueued"
+CONF_UPDATES_APPLIED = "updates_applied"
+CONF_UPDATES_SUPPRESSED = "updates_suppressed"
+CONF_PANEL_ID = "panel_id"
+CONF_BURN_IN = "burn_in"
+CONF_SHIFT_INTERVAL = "shift_interval"
+CONF_MAX_OFFSET = "max_offset"
+CONF_INVERT_INTERVAL = "invert_interval"
+CONF_REFRESH_ORDER = "refresh_order"
+CONF_BASELINE_FRAME_INTERVAL = "baseline_frame_interval"
+CONF_BUS_BYTES = "bus_bytes"
+CONF_BUS_BYTES_SAVED_ESTIMATE = "bus_bytes_saved_estimate"
+CONF_CPU_TIME = "cpu_time"
+CONF_PAGE_CACHE = "page_cache"
+CONF_PAGES = "pages"
+CONF_PAGE_SIZE = "page_size"
+CONF_TILE_SLOT_SIZE = "tile_slot_size"
+CONF_MAX_AGE = "max_age"
+CONF_CACHED_SWITCH_TIME = "cached_switch_time"
+CONF_UNCACHED_SWITCH_TIME = "uncached_switch_time"
+CONF_HITS = "hits"
+CONF_MISSES = "misses"
+CONF_MIRROR = "mirror"
+CONF_MAX_RATE = "max_rate"
+CONF_MAX_BURST = "max_burst"
+CONF_BYTES_SENT = "bytes_sent"
+CONF_FRAMES_SENT = "frames_sent"
+CONF_LOG_SINK = "log_sink"
+CONF_RING_SIZE = "ring_size"
+CONF_RENDER_INTERVAL = "render_interval"
+CONF_MAX_LINES = "max_lines"
+CONF_MAX_CHARS = "max_chars"
+CONF_DROPPED = "dropped"
+CONF_KEYBOARD = "keyboard"
+CONF_SCRIPTED_KEYBOARD = "scripted_keyboard"
+CONF_POLL_INTERVAL = "poll_interval"
+CONF_ON_KEY = "on_key"
+CONF_KEYS = "keys"
+CONF_KEY_INTERVAL = "key_interval"
+CONF_READ_DELAY = "read_delay"
+CONF_REPEAT = "repeat"
+CONF_HOST_PANEL = "host_panel"
+CONF_LATENCY = "latency"
+CONF_REQUIRE_STATE_CHANGE = "require_state_change"
+CONF_P50 = "p50"
+CONF_P95 = "p95"
+CONF_P99 = "p99"
+CONF_EVENTS = "events"
+CONF_EXPIRED = "expired"
+CONF_IDLE = "idle"
+CONF_DIM_AFTER = "dim_after"
+CONF_IDLE_AFTER = "idle_after"
+CONF_SLEEP_AFTER = "sleep_after"
+CONF_DIM_FRAME_RATE = "dim_frame_rate"
+CONF_IDLE_FRAME_RATE = "idle_frame_rate"
+CONF_IDLE_UPDATE_INTERVAL = "idle_update_interval"
+CONF_ACTIVE_RESIDENCY = "active_residency"
+CONF_DIM_RESIDENCY = "dim_residency"
+CONF_IDLE_RESIDENCY = "idle_residency"
+CONF_SLEEP_RESIDENCY = "sleep_residency"
 
 picocalc_ns = cg.esphome_ns.namespace("picocalc")
 PicoCalc = picocalc_ns.class_(
     "PicoCalc", cg.Component
 )
+Panel = picocalc_ns.class_("Panel")
+Ili9xxxPanel = picocalc_ns.class_("Ili9xxxPanel", Panel)
+BurnIn = picocalc_ns.class_("BurnIn")
+PageCache = picocalc_ns.class_("PageCache")
+ScreenMirror = picocalc_ns.class_("ScreenMirror")
+LogSink = picocalc_ns.class_("LogSink")
+KeySource = picocalc_ns.class_("KeySource")
+Keyboard = picocalc_ns.class_("Keyboard", KeySource, i2c.I2CDevice)
+ScriptedKeyboard = picocalc_ns.class_("ScriptedKeyboard", KeySource)
+KeyTrigger = picocalc_ns.class_("KeyTrigger", automation.Trigger.template(cg.uint8, cg.uint8))
+HostPanel = picocalc_ns.class_("HostPanel", Panel)
+LatencyTracer = picocalc_ns.class_("LatencyTracer")
+LoopPassMarker = picocalc_ns.class_("LoopPassMarker", cg.Component)
+IdleManager = picocalc_ns.class_("IdleManager")
+IdleState = picocalc_ns.enum("IdleState")
+ILI9XXXDisplay = cg.esphome_ns.namespace("ili9xxx").class_("ILI9XXXDisplay")
+
+
+def _diagnostic_sensor(unit=None, accuracy=0, state_class=STATE_CLASS_MEASUREMENT):
+    return sensor.sensor_schema(
+        unit_of_measurement=unit,
+        accuracy_decimals=accuracy,
+        state_class=state_class,
+        entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+    )
+
+
+# Every bus sensor reports the per-frame average over one update_interval.
+# Only the adafruit_gfx driver is instrumented; the ili9xxx one used with LVGL
+# has no counters, so bus_stats needs adafruit_gfx.
+BUS_STATS_SCHEMA = cv.Schema(
+    {
+        cv.Optional(CONF_UPDATE_INTERVAL, default="10s"): cv.positive_time_period_milliseconds,
+        cv.Optional(CONF_COMMANDS): _diagnostic_sensor(),
+        cv.Optional(CONF_DATA_BYTES): _diagnostic_sensor(UNIT_BYTES),
+        cv.Optional(CONF_WINDOWS): _diagnostic_sensor(),
+        cv.Optional(CONF_CS_TOGGLES): _diagnostic_sensor(),
+        cv.Optional(CONF_BUSY_TIME): _diagnostic_sensor(UNIT_MICROSECOND),
+    }
+)
+
+# Loop sensors describe the work of one pass over all component loops,
+# timed between two marker components that run first and last; the sleep
+# between passes is not included. picocalc's and adafruit_gfx's own loop()
+# get slots of their own; everything traced ends up in the histograms and the
+# slow-call list that are logged each update_interval.
+LOOP_TRACE_SCHEMA = cv.Schema(
+    {
+        cv.GenerateID(CONF_PASS_START_ID): cv.declare_id(LoopPassMarker),
+        cv.GenerateID(CONF_PASS_END_ID): cv.declare_id(LoopPassMarker),
+        cv.Optional(CONF_UPDATE_INTERVAL, default="60s"): cv.positive_time_period_milliseconds,
+        cv.Optional(CONF_SLOW_THRESHOLD, default="30ms"): cv.positive_time_period_microseconds,
+        cv.Optional(CONF_LOOP_TIME_P99): _diagnostic_sensor(UNIT_MICROSECOND),
+        cv.Optional(CONF_LOOP_TIME_MAX): _diagnostic_sensor(UNIT_MICROSECOND),
+        cv.Optional(CONF_SLOW_CALLS): _diagnostic_sensor(),
+    }
+)
+
+MEMORY_BUDGET_SCHEMA = cv.Schema(
+    {
+        cv.Required(CONF_NAME): cv.string_strict,
+        cv.Required(CONF_LIMIT): cv.All(cv.int_, cv.positive_int),
+    }
+)
+
+# display_memory is the sum of what every registered budget currently holds.
+# Budgets listed here are for subsystems outside this component; a lambda
+# reports their usage with id(picocalc).set_memory_used("name", bytes).
+# stack_high_water switches an RP2040 build to FreeRTOS and reads unknown
+# (NaN) where task stacks cannot be inspected.
+MEMORY_SCHEMA = cv.Schema(
+    {
+        cv.Optional(CONF_UPDATE_INTERVAL, default="30s"): cv.positive_time_period_milliseconds,
+        cv.Optional(CONF_BUDGETS, default=[]): cv.ensure_list(MEMORY_BUDGET_SCHEMA),
+        cv.Optional(CONF_FREE_HEAP): _diagnostic_sensor(UNIT_BYTES),
+        cv.Optional(CONF_LARGEST_FREE_BLOCK): _diagnostic_sensor(UNIT_BYTES),
+        cv.Optional(CONF_STACK_HIGH_WATER): _diagnostic_sensor(UNIT_BYTES),
+        cv.Optional(CONF_DISPLAY_MEMORY): _diagnostic_sensor(UNIT_BYTES),
+    }
+)
+
+# The frame arena is scratch space reset on every main loop pass; label slots
+# back the text of LVGL labels queued through PicoCalc::set_label_text().
+# render_heap_allocations counts malloc calls on core 0 during rendering; only
+# when it is set is the firmware's allocator wrapped at link time to do so.
+ALLOCATORS_SCHEMA = cv.Schema(
+    {
+        cv.Optional(CONF_UPDATE_INTERVAL, default="60s"): cv.positive_time_period_milliseconds,
+        cv.Optional(CONF_FRAME_ARENA_SIZE, default=2048): cv.int_range(min=64, max=65536),
+        cv.Optional(CONF_LABEL_SLOTS, default=8): cv.int_range(min=1, max=64),
+        cv.Optional(CONF_ARENA_HIGH_WATER): _diagnostic_sensor(UNIT_BYTES),
+        cv.Optional(CONF_POOL_IN_USE): _diagnostic_sensor(),
+        cv.Optional(CONF_ALLOC_FAILURES): _diagnostic_sensor(),
+        cv.Optional(CONF_RENDER_HEAP_ALLOCATIONS): _diagnostic_sensor(),
+    }
+)
+
+# Label updates made through set_label_text() are applied once per LVGL
+# frame, right before it renders; the counters are running totals since boot.
+UPDATE_QUEUE_SCHEMA = cv.Schema(
+    {
+        cv.Optional(CONF_UPDATE_INTERVAL, default="60s"): cv.positive_time_period_milliseconds,
+        cv.Optional(CONF_UPDATES_ENQUEUED): _diagnostic_sensor(state_class=STATE_CLASS_TOTAL_INCREASING),
+        cv.Optional(CONF_UPDATES_APPLIED): _diagnostic_sensor(state_class=STATE_CLASS_TOTAL_INCREASING),
+        cv.Optional(CONF_UPDATES_SUPPRESSED): _diagnostic_sensor(state_class=STATE_CLASS_TOTAL_INCREASING),
+    }
+)
+
+# The sensors cover the current (or last) burn-in run. bus_bytes_saved_estimate
+# is not measured: it compares the bytes sent with what full-screen snow at
+# baseline_frame_interval would have sent.
+BURN_IN_SCHEMA = cv.Schema(
+    {
+        cv.GenerateID(): cv.declare_id(BurnIn),
+        cv.Optional(CONF_SHIFT_INTERVAL, default="60s"): cv.positive_time_period_milliseconds,
+        cv.Optional(CONF_MAX_OFFSET, default=8): cv.int_range(min=0, max=64),
+        cv.Optional(CONF_INVERT_INTERVAL): cv.positive_time_period_milliseconds,
+        cv.Optional(CONF_REFRESH_ORDER, default=False): cv.boolean,
+        cv.Optional(CONF_BASELINE_FRAME_INTERVAL, default="100ms"): cv.positive_time_period_milliseconds,
+        cv.Optional(CONF_BUS_BYTES): _diagnostic_sensor(UNIT_BYTES),
+        cv.Optional(CONF_BUS_BYTES_SAVED_ESTIMATE): _diagnostic_sensor(UNIT_BYTES),
+        cv.Optional(CONF_CPU_TIME): _diagnostic_sensor(UNIT_MICROSECOND),
+    }
+)
+
+# Switch times run from leaving a page to the last flush of the new one and
+# are reported per switch; the cache can be turned off at runtime with
+# set_page_cache_enabled() to compare both. Labels changed through
+# set_label_text() are redrawn on restore; a page whose other widgets changed
+# text, value, state or position is rendered in full, and max_age covers the
+# rest (style and image changes).
+PAGE_CACHE_SCHEMA = cv.Schema(
+    {
+        cv.GenerateID(): cv.declare_id(PageCache),
+        cv.Optional(CONF_ENABLED, default=True): cv.boolean,
+        cv.Optional(CONF_PAGES, default=2): cv.int_range(min=1, max=8),
+        cv.Optional(CONF_PAGE_SIZE, default=16384): cv.int_range(min=1024, max=262144),
+        cv.Optional(CONF_TILE_SLOT_SIZE, default=384): cv.int_range(min=64, max=4096),
+        cv.Optional(CONF_MAX_AGE, default="10min"): cv.positive_time_period_milliseconds,
+        cv.Optional(CONF_CACHED_SWITCH_TIME): _diagnostic_sensor(UNIT_MILLISECOND, 1),
+        cv.Optional(CONF_UNCACHED_SWITCH_TIME): _diagnostic_sensor(UNIT_MILLISECOND, 1),
+        cv.Optional(CONF_HITS): _diagnostic_sensor(state_class=STATE_CLASS_TOTAL_INCREASING),
+        cv.Optional(CONF_MISSES): _diagnostic_sensor(state_class=STATE_CLASS_TOTAL_INCREASING),
+    }
+)
+
+# Serves damaged screen tiles over TCP; scripts/mirror_client.py is the
+# viewer. max_rate and max_burst bound what one loop pass may send.
+MIRROR_SCHEMA = cv.Schema(
+    {
+        cv.GenerateID(): cv.declare_id(ScreenMirror),
+        cv.Optional(CONF_PORT, default=6063): cv.port,
+        cv.Optional(CONF_MAX_RATE, default=100000): cv.int_range(min=1000, max=10000000),
+        cv.Optional(CONF_MAX_BURST, default=4096): cv.int_range(min=256, max=65536),
+        cv.Optional(CONF_TILE_SLOT_SIZE, default=384): cv.int_range(min=64, max=4096),
+        cv.Optional(CONF_UPDATE_INTERVAL, default="60s"): cv.positive_time_period_milliseconds,
+        cv.Optional(CONF_BYTES_SENT): _diagnostic_sensor(UNIT_BYTES, state_class=STATE_CLASS_TOTAL_INCREASING),
+        cv.Optional(CONF_FRAMES_SENT): _diagnostic_sensor(state_class=STATE_CLASS_TOTAL_INCREASING),
+    }
+)
+
+# Log lines at or above `level` are shown in the textarea handed to
+# PicoCalc::set_log_textarea(). At most max_lines are appended per
+# render_interval; the rest, and lines that find the ring full, are dropped.
+LOG_SINK_SCHEMA = cv.Schema(
+    {
+        cv.GenerateID(): cv.declare_id(LogSink),
+        cv.Optional(CONF_LEVEL, default="INFO"): is_log_level,
+        cv.Optional(CONF_RING_SIZE, default=32): cv.int_range(min=4, max=1024),
+        cv.Optional(CONF_RENDER_INTERVAL, default="250ms"): cv.positive_time_period_milliseconds,
+        cv.Optional(CONF_MAX_LINES, default=4): cv.int_range(min=1, max=8),
+        cv.Optional(CONF_MAX_CHARS, default=1024): cv.int_range(min=128, max=8192),
+        cv.Optional(CONF_UPDATE_INTERVAL, default="60s"): cv.positive_time_period_milliseconds,
+        cv.Optional(CONF_DROPPED): _diagnostic_sensor(state_class=STATE_CLASS_TOTAL_INCREASING),
+    }
+)
+
+# on_key runs with `key` and `state` (1 pressed, 2 held, 3 released) for
+# every event; key events also count as activity for the idle manager.
+KEY_SOURCE_SCHEMA = cv.Schema(
+    {
+        cv.Optional(CONF_POLL_INTERVAL, default="50ms"): cv.positive_time_period_milliseconds,
+        cv.Optional(CONF_ON_KEY): automation.validate_automation(
+            {cv.GenerateID(CONF_TRIGGER_ID): cv.declare_id(KeyTrigger)}
+        ),
+    }
+)
+
+# The keyboard controller on the PicoCalc's I2C bus.
+KEYBOARD_SCHEMA = KEY_SOURCE_SCHEMA.extend(
+    {cv.GenerateID(): cv.declare_id(Keyboard)}
+).extend(i2c.i2c_device_schema(0x1F))
+
+# Stand-in for the keyboard on hosts: types `keys` one per key_interval.
+# read_delay models the I2C reads of a poll (about 5ms at 10kHz).
+SCRIPTED_KEYBOARD_SCHEMA = KEY_SOURCE_SCHEMA.extend(
+    {
+        cv.GenerateID(): cv.declare_id(ScriptedKeyboard),
+        cv.Required(CONF_KEYS): cv.string_strict,
+        cv.Optional(CONF_KEY_INTERVAL, default="250ms"): cv.positive_time_period_milliseconds,
+        cv.Optional(CONF_READ_DELAY, default="0us"): cv.positive_time_period_microseconds,
+        cv.Optional(CONF_REPEAT, default=True): cv.boolean,
+    }
+)
+
+# Stand-in for the display controller on hosts; holds every LVGL flush for
+# its SPI transfer time at `frequency`.
+HOST_PANEL_SCHEMA = cv.Schema(
+    {
+        cv.GenerateID(): cv.declare_id(HostPanel),
+        cv.Optional(CONF_FREQUENCY, default="40MHz"): cv.frequency,
+    }
+)
+
+# Key press to the end of the flush that shows it. The percentiles cover the
+# presses completed in one update_interval; presses that change no label
+# (or call mark_state_changed()) within timeout count as expired.
+LATENCY_SCHEMA = cv.Schema(
+    {
+        cv.GenerateID(): cv.declare_id(LatencyTracer),
+        cv.Optional(CONF_TIMEOUT, default="1s"): cv.positive_time_period_milliseconds,
+        cv.Optional(CONF_REQUIRE_STATE_CHANGE, default=True): cv.boolean,
+        cv.Optional(CONF_UPDATE_INTERVAL, default="60s"): cv.positive_time_period_milliseconds,
+        cv.Optional(CONF_P50): _diagnostic_sensor(UNIT_MILLISECOND, 1),
+        cv.Optional(CONF_P95): _diagnostic_sensor(UNIT_MILLISECOND, 1),
+        cv.Optional(CONF_P99): _diagnostic_sensor(UNIT_MILLISECOND, 1),
+        cv.Optional(CONF_EVENTS): _diagnostic_sensor(),
+        cv.Optional(CONF_EXPIRED): _diagnostic_sensor(),
+    }
+)
+
+# Each *_after is measured from the last key or flushed frame; 0s skips that
+# step. The residency sensors report the share of each update_interval spent
+# in a state. Sleep only puts the panel into SLPIN: the MCU clocks stay as
+# they are, because a divided clk_sys would also slow the keyboard's I2C bus
+# (the wake source), the CYW43 PIO and PWM.
+IDLE_SCHEMA = cv.Schema(
+    {
+        cv.GenerateID(): cv.declare_id(IdleManager),
+        cv.Optional(CONF_DIM_AFTER, default="30s"): cv.positive_time_period_milliseconds,
+        cv.Optional(CONF_IDLE_AFTER, default="2min"): cv.positive_time_period_milliseconds,
+        cv.Optional(CONF_SLEEP_AFTER, default="10min"): cv.positive_time_period_milliseconds,
+        cv.Optional(CONF_DIM_FRAME_RATE, default=30): cv.float_range(min=20, max=120),
+        cv.Optional(CONF_IDLE_FRAME_RATE, default=15): cv.float_range(min=10, max=120),
+        cv.Optional(CONF_IDLE_UPDATE_INTERVAL, default="1s"): cv.positive_time_period_milliseconds,
+        cv.Optional(CONF_UPDATE_INTERVAL, default="60s"): cv.positive_time_period_milliseconds,
+        cv.Optional(CONF_ACTIVE_RESIDENCY): _diagnostic_sensor(UNIT_PERCENT, 1),
+        cv.Optional(CONF_DIM_RESIDENCY): _diagnostic_sensor(UNIT_PERCENT, 1),
+        cv.Optional(CONF_IDLE_RESIDENCY): _diagnostic_sensor(UNIT_PERCENT, 1),
+        cv.Optional(CONF_SLEEP_RESIDENCY): _diagnostic_sensor(UNIT_PERCENT, 1),
+    }
+)
 
 CONFIG_SCHEMA = (
-    cv.Schema({cv.GenerateID(): cv.declare_id(PicoCalc)})
+    cv.Schema(
+        {
+            cv.GenerateID(): cv.declare_id(PicoCalc),
+            cv.Optional(CONF_BUS_STATS): cv.All(BUS_STATS_SCHEMA, cv.requires_component("adafruit_gfx")),
+            cv.Optional(CONF_LOOP_TRACE): LOOP_TRACE_SCHEMA,
+            cv.Optional(CONF_MEMORY): MEMORY_SCHEMA,
+            cv.Optional(CONF_ALLOCATORS, default={}): ALLOCATORS_SCHEMA,
+            cv.Optional(CONF_UPDATE_QUEUE): cv.All(UPDATE_QUEUE_SCHEMA, cv.requires_component("lvgl")),
+            # The ili9xxx display to send panel commands through when adafruit_gfx is not used.
+            cv.Optional(CONF_DISPLAY_ID): cv.use_id(ILI9XXXDisplay),
+            cv.GenerateID(CONF_PANEL_ID): cv.declare_id(Ili9xxxPanel),
+            cv.Optional(CONF_BURN_IN): BURN_IN_SCHEMA,
+            cv.Optional(CONF_PAGE_CACHE): cv.All(PAGE_CACHE_SCHEMA, cv.requires_component("lvgl")),
+            cv.Optional(CONF_MIRROR): cv.All(MIRROR_SCHEMA, cv.requires_component("lvgl")),
+            cv.Optional(CONF_LOG_SINK): cv.All(
+                LOG_SINK_SCHEMA, cv.requires_component("lvgl"), cv.requires_component("logger")
+            ),
+            cv.Exclusive(CONF_KEYBOARD, CONF_KEYBOARD): KEYBOARD_SCHEMA,
+            cv.Exclusive(CONF_SCRIPTED_KEYBOARD, CONF_KEYBOARD): SCRIPTED_KEYBOARD_SCHEMA,
+            cv.Optional(CONF_HOST_PANEL): HOST_PANEL_SCHEMA,
+            cv.Optional(CONF_LATENCY): cv.All(LATENCY_SCHEMA, cv.requires_component("lvgl")),
+            cv.Optional(CONF_IDLE): IDLE_SCHEMA,
+        }
+    )
     .extend(cv.COMPONENT_SCHEMA)
 )
 
+
+async def _add_sensors(var, config, keys):
+    for key in keys:
+        if key in config:
+            sens = await sensor.new_sensor(config[key])
+            cg.add(getattr(var, f"set_{key}_sensor")(sens))
+
+
+async def _setup_key_source(var, keyboard, config):
+    cg.add_define("USE_PICOCALC_KEYBOARD")
+    cg.add(keyboard.set_poll_interval(config[CONF_POLL_INTERVAL]))
+    for conf in config.get(CONF_ON_KEY, []):
+        trigger = cg.new_Pvariable(conf[CONF_TRIGGER_ID], keyboard)
+        await automation.build_automation(trigger, [(cg.uint8, "key"), (cg.uint8, "state")], conf)
+    cg.add(var.set_keyboard(keyboard))
+
+
 async def to_code(config):
     var = cg.new_Pvariable(config[CONF_ID])
-    await cg.register_component(var, config)
\ No newline at end of file
+    await cg.register_component(var, config)
+
+    if bus_config := config.get(CONF_BUS_STATS):
+        cg.add_define("USE_PICOCALC_BUS_STATS")
+        cg.add(var.set_bus_stats_interval(bus_config[CONF_UPDATE_INTERVAL]))
+        await _add_sensors(
+            var,
+            bus_config,
+            (CONF_COMMANDS, CONF_DATA_BYTES, CONF_WINDOWS, CONF_CS_TOGGLES, CONF_BUSY_TIME),
+        )
+
+    if trace_config := config.get(CONF_LOOP_TRACE):
+        cg.add_define("USE_PICOCALC_LOOP_TRACE")
+        cg.add(var.set_loop_trace_interval(trace_config[CONF_UPDATE_INTERVAL]))
+        cg.add(var.set_slow_threshold(trace_config[CONF_SLOW_THRESHOLD]))
+        pass_start = cg.new_Pvariable(trace_config[CONF_PASS_START_ID])
+        await cg.register_component(pass_start, {})
+        pass_end = cg.new_Pvariable(trace_config[CONF_PASS_END_ID], pass_start)
+        await cg.register_component(pass_end, {})
+        cg.add(var.set_loop_pass_marker(pass_end))
+        await _add_sensors(
+            var,
+            trace_config,
+            (CONF_LOOP_TIME_P99, CONF_LOOP_TIME_MAX, CONF_SLOW_CALLS),
+        )
+
+    if memory_config := config.get(CONF_MEMORY):
+        cg.add_define("USE_PICOCALC_MEMORY")
+        if CONF_STACK_HIGH_WATER in memory_config and CORE.is_rp2040:
+            # Stack marks need FreeRTOS; including FreeRTOS.h makes arduino-pico
+            # run the loop as a task, so only ask for it when the sensor is set.
+            cg.add_define("USE_PICOCALC_FREERTOS")
+        cg.add(var.set_memory_interval(memory_config[CONF_UPDATE_INTERVAL]))
+        for budget in memory_config[CONF_BUDGETS]:
+            cg.add(var.add_memory_budget(budget[CONF_NAME], budget[CONF_LIMIT]))
+        await _add_sensors(
+            var,
+            memory_config,
+            (CONF_FREE_HEAP, CONF_LARGEST_FREE_BLOCK, CONF_STACK_HIGH_WATER, CONF_DISPLAY_MEMORY),
+        )
+
+    alloc_config = config[CONF_ALLOCATORS]
+    cg.add_define("PICOCALC_FRAME_ARENA_SIZE", alloc_config[CONF_FRAME_ARENA_SIZE])
+    cg.add_define("PICOCALC_LABEL_SLOTS", alloc_config[CONF_LABEL_SLOTS])
+    cg.add(var.set_allocators_interval(alloc_config[CONF_UPDATE_INTERVAL]))
+    if CONF_RENDER_HEAP_ALLOCATIONS in alloc_config:
+        cg.add_define("USE_PICOCALC_HEAP_PROBE")
+        if CORE.is_rp2040:
+            # Routes newlib's allocator through __wrap__malloc_r() in arena.cpp so
+            # the render heap probe counts calls rather than net heap growth.
+            cg.add_build_flag("-Wl,--wrap=_malloc_r")
+    await _add_sensors(
+        var,
+        alloc_config,
+        (CONF_ARENA_HIGH_WATER, CONF_POOL_IN_USE, CONF_ALLOC_FAILURES, CONF_RENDER_HEAP_ALLOCATIONS),
+    )
+
+    if queue_config := config.get(CONF_UPDATE_QUEUE):
+        cg.add(var.set_update_queue_interval(queue_config[CONF_UPDATE_INTERVAL]))
+        await _add_sensors(
+            var,
+            queue_config,
+            (CONF_UPDATES_ENQUEUED, CONF_UPDATES_APPLIED, CONF_UPDATES_SUPPRESSED),
+        )
+
+    if CONF_DISPLAY_ID in config:
+        display = await cg.get_variable(config[CONF_DISPLAY_ID])
+        cg.add_define("USE_PICOCALC_ILI9XXX")
+        panel = cg.new_Pvariable(config[CONF_PANEL_ID], display)
+        cg.add(var.set_panel(panel))
+
+    if burn_config := config.get(CONF_BURN_IN):
+        burn_in = cg.new_Pvariable(burn_config[CONF_ID])
+        cg.add(burn_in.set_shift_interval(burn_config[CONF_SHIFT_INTERVAL]))
+        cg.add(burn_in.set_max_offset(burn_config[CONF_MAX_OFFSET]))
+        if CONF_INVERT_INTERVAL in burn_config:
+            cg.add(burn_in.set_invert_interval(burn_config[CONF_INVERT_INTERVAL]))
+        cg.add(burn_in.set_refresh_order(burn_config[CONF_REFRESH_ORDER]))
+        cg.add(burn_in.set_baseline_frame_interval(burn_config[CONF_BASELINE_FRAME_INTERVAL]))
+        await _add_sensors(burn_in, burn_config, (CONF_BUS_BYTES, CONF_BUS_BYTES_SAVED_ESTIMATE, CONF_CPU_TIME))
+        cg.add(var.set_burn_in(burn_in))
+
+    if cache_config := config.get(CONF_PAGE_CACHE):
+        cache = cg.new_Pvariable(cache_config[CONF_ID])
+        cg.add(cache.set_enabled(cache_config[CONF_ENABLED]))
+        cg.add(cache.set_pages(cache_config[CONF_PAGES]))
+        cg.add(cache.set_page_size(cache_config[CONF_PAGE_SIZE]))
+        cg.add(cache.set_tile_slot_size(cache_config[CONF_TILE_SLOT_SIZE]))
+        cg.add(cache.set_max_age(cache_config[CONF_MAX_AGE]))
+        await _add_sensors(
+            cache,
+            cache_config,
+            (CONF_CACHED_SWITCH_TIME, CONF_UNCACHED_SWITCH_TIME, CONF_HITS, CONF_MISSES),
+        )
+        cg.add(var.set_page_cache(cache))
+
+    if mirror_config := config.get(CONF_MIRROR):
+        cg.add_define("USE_PICOCALC_MIRROR")
+        mirror = cg.new_Pvariable(mirror_config[CONF_ID])
+        cg.add(mirror.set_port(mirror_config[CONF_PORT]))
+        cg.add(mirror.set_max_rate(mirror_config[CONF_MAX_RATE]))
+        cg.add(mirror.set_max_burst(mirror_config[CONF_MAX_BURST]))
+        cg.add(mirror.set_tile_slot_size(mirror_config[CONF_TILE_SLOT_SIZE]))
+        cg.add(mirror.set_update_interval(mirror_config[CONF_UPDATE_INTERVAL]))
+        await _add_sensors(mirror, mirror_config, (CONF_BYTES_SENT, CONF_FRAMES_SENT))
+        cg.add(var.set_mirror(mirror))
+
+    if sink_config := config.get(CONF_LOG_SINK):
+        sink = cg.new_Pvariable(sink_config[CONF_ID])
+        cg.add(sink.set_level(LOG_LEVELS[sink_config[CONF_LEVEL]]))
+        cg.add(sink.set_ring_size(sink_config[CONF_RING_SIZE]))
+        cg.add(sink.set_render_interval(sink_config[CONF_RENDER_INTERVAL]))
+        cg.add(sink.set_max_lines(sink_config[CONF_MAX_LINES]))
+        cg.add(sink.set_max_chars(sink_config[CONF_MAX_CHARS]))
+        cg.add(sink.set_update_interval(sink_config[CONF_UPDATE_INTERVAL]))
+        await _add_sensors(sink, sink_config, (CONF_DROPPED,))
+        cg.add(var.set_log_sink(sink))
+
+    if keyboard_config := config.get(CONF_KEYBOARD):
+        cg.add_define("USE_PICOCALC_KEYBOARD_I2C")
+        keyboard = cg.new_Pvariable(keyboard_config[CONF_ID])
+        await i2c.register_i2c_device(keyboard, keyboard_config)
+        await _setup_key_source(var, keyboard, keyboard_config)
+
+    if keyboard_config := config.get(CONF_SCRIPTED_KEYBOARD):
+        keyboard = cg.new_Pvariable(keyboard_config[CONF_ID])
+        cg.add(keyboard.set_script(keyboard_config[CONF_KEYS]))
+        cg.add(keyboard.set_key_interval(keyboard_config[CONF_KEY_INTERVAL]))
+        cg.add(keyboard.set_read_delay(keyboard_config[CONF_READ_DELAY]))
+        cg.add(keyboard.set_repeat(keyboard_config[CONF_REPEAT]))
+        await _setup_key_source(var, keyboard, keyboard_config)
+
+    if panel_config := config.get(CONF_HOST_PANEL):
+        panel = cg.new_Pvariable(panel_config[CONF_ID])
+        cg.add(panel.set_spi_frequency(int(panel_config[CONF_FREQUENCY])))
+        cg.add(var.set_host_panel(panel))
+
+    if latency_config := config.get(CONF_LATENCY):
+        latency = cg.new_Pvariable(latency_config[CONF_ID])
+        cg.add(latency.set_timeout(latency_config[CONF_TIMEOUT]))
+        cg.add(latency.set_require_state(latency_config[CONF_REQUIRE_STATE_CHANGE]))
+        cg.add(latency.set_update_interval(latency_config[CONF_UPDATE_INTERVAL]))
+        await _add_sensors(latency, latency_config, (CONF_P50, CONF_P95, CONF_P99, CONF_EVENTS, CONF_EXPIRED))
+        cg.add(var.set_latency_tracer(latency))
+
+    if idle_config := config.get(CONF_IDLE):
+        idle = cg.new_Pvariable(idle_config[CONF_ID])
+        for state, key in (
+            ("IDLE_STATE_DIM", CONF_DIM_AFTER),
+            ("IDLE_STATE_IDLE", CONF_IDLE_AFTER),
+            ("IDLE_STATE_SLEEP", CONF_SLEEP_AFTER),
+        ):
+            cg.add(idle.set_timeout(getattr(IdleState, state), idle_config[key]))
+        cg.add(idle.set_dim_frame_rate(idle_config[CONF_DIM_FRAME_RATE]))
+        cg.add(idle.set_idle_frame_rate(idle_config[CONF_IDLE_FRAME_RATE]))
+        cg.add(idle.set_idle_update_interval(idle_config[CONF_IDLE_UPDATE_INTERVAL]))
+        cg.add(idle.set_update_interval(idle_config[CONF_UPDATE_INTERVAL]))
+        await _add_sensors(
+            idle,
+            idle_config,
+            (CONF_ACTIVE_RESIDENCY, CONF_DIM_RESIDENCY, CONF_IDLE_RESIDENCY, CONF_SLEEP_RESIDENCY),
+        )
+        cg.add(var.set_idle_manager(idle))
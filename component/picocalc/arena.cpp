@@ -0,0 +1,96 @@
+#include "arena.h"
+#include <cstdio>
+#include "esphome/core/defines.h"
+
+#if defined(USE_RP2040) && defined(USE_PICOCALC_HEAP_PROBE)
+#include <reent.h>
+#include <pico/platform.h>
+
+// malloc, calloc, operator new and any realloc that needs a new block end up
+// here; see the --wrap=_malloc_r build flag added with render_heap_allocations.
+// Only core 0 counts: it runs the main loop and LVGL, and a single writer
+// needs no atomics.
+static volatile uint32_t heap_alloc_calls = 0;
+
+extern "C" void *__real__malloc_r(struct _reent *reent, size_t size);
+
+extern "C" void *__wrap__malloc_r(struct _reent *reent, size_t size)
+{
+    if (get_core_num() == 0)
+        heap_alloc_calls++;
+    return __real__malloc_r(reent, size);
+}
+#endif
+
+namespace esphome
+{
+    namespace picocalc
+    {
+        void *Arena::allocate(size_t size, size_t align)
+        {
+            size_t start = (this->used_ + align - 1) & ~(align - 1);
+            if (start + size > this->capacity_)
+            {
+                this->stats_.failures++;
+                return nullptr;
+            }
+            this->used_ = start + size;
+            this->stats_.allocations++;
+            this->stats_.in_use = this->used_;
+            if (this->used_ > this->stats_.high_water)
+                this->stats_.high_water = this->used_;
+            return this->storage_ + start;
+        }
+
+        const char *Arena::format(const char *fmt, ...)
+        {
+            va_list args;
+            va_start(args, fmt);
+            const char *result = this->vformat(fmt, args);
+            va_end(args);
+            return result;
+        }
+
+        const char *Arena::vformat(const char *fmt, va_list args)
+        {
+            size_t available = this->capacity_ - this->used_;
+            char *out = reinterpret_cast<char *>(this->storage_ + this->used_);
+            int length = vsnprintf(out, available, fmt, args);
+            if (length < 0 || size_t(length) >= available)
+            {
+                this->stats_.failures++;
+                return nullptr;
+            }
+            return static_cast<const char *>(this->allocate(length + 1, 1));
+        }
+
+        void Arena::release(size_t mark)
+        {
+            if (mark < this->used_)
+                this->used_ = mark;
+            this->stats_.in_use = this->used_;
+        }
+
+        static uint32_t heap_alloc_count()
+        {
+#if defined(USE_RP2040) && defined(USE_PICOCALC_HEAP_PROBE)
+            return heap_alloc_calls;
+#else
+            return 0;
+#endif
+        }
+
+        void HeapProbe::begin()
+        {
+            if (this->depth_++ == 0)
+                this->start_calls_ = heap_alloc_count();
+        }
+
+        void HeapProbe::end()
+        {
+            if (this->depth_ == 0 || --this->depth_ != 0)
+                return;
+            this->allocations_ += heap_alloc_count() - this->start_calls_;
+        }
+    } // namespace picocalc
+} // namespace esphome
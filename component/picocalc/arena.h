@@ -0,0 +1,136 @@
+#pragma once
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+
+namespace esphome {
+namespace picocalc {
+
+// Counters shared by the arena and the pools so they can be reported alike.
+struct AllocStats {
+    uint32_t allocations{0};
+    uint32_t failures{0};
+    uint32_t in_use{0};
+    uint32_t high_water{0};
+};
+
+// Bump allocator over caller-provided storage. Nothing is freed individually;
+// callers either reset() the whole arena or roll back to a mark().
+class Arena {
+    public:
+        Arena(uint8_t *storage, size_t capacity) : storage_(storage), capacity_(capacity) {}
+
+        void *allocate(size_t size, size_t align = alignof(max_align_t));
+        // vsnprintf into the arena; returns nullptr (and counts a failure) when it does not fit.
+        const char *format(const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+        const char *vformat(const char *fmt, va_list args);
+
+        size_t mark() const { return this->used_; }
+        void release(size_t mark);
+        void reset() { this->release(0); }
+
+        size_t capacity() const { return this->capacity_; }
+        const AllocStats &stats() const { return this->stats_; }
+
+    protected:
+        uint8_t *storage_;
+        size_t capacity_;
+        size_t used_{0};
+        AllocStats stats_{};
+};
+
+template<size_t N> class StaticArena : public Arena {
+    public:
+        StaticArena() : Arena(this->buffer_, N) {}
+
+    protected:
+        alignas(max_align_t) uint8_t buffer_[N];
+};
+
+// Fixed-capacity pool of T. Slots are handed out from an intrusive free list,
+// so create() and destroy() are O(1) and never touch the heap.
+template<typename T, size_t N> class ObjectPool {
+    static_assert(N > 0 && N < 0xFFFF, "pool size out of range");
+
+    public:
+        ObjectPool()
+        {
+            for (size_t i = 0; i < N; i++)
+                this->next_free_[i] = i + 1;
+        }
+
+        template<typename... Args> T *create(Args &&...args)
+        {
+            if (this->free_head_ >= N)
+            {
+                this->stats_.failures++;
+                return nullptr;
+            }
+            uint16_t index = this->free_head_;
+            this->free_head_ = this->next_free_[index];
+            this->stats_.allocations++;
+            if (++this->stats_.in_use > this->stats_.high_water)
+                this->stats_.high_water = this->stats_.in_use;
+            return new (this->slots_[index]) T(std::forward<Args>(args)...);
+        }
+
+        void destroy(T *object)
+        {
+            if (object == nullptr)
+                return;
+            size_t index = (reinterpret_cast<uint8_t *>(object) - &this->slots_[0][0]) / sizeof(T);
+            object->~T();
+            this->next_free_[index] = this->free_head_;
+            this->free_head_ = index;
+            this->stats_.in_use--;
+        }
+
+        static constexpr size_t capacity() { return N; }
+        static constexpr size_t storage_size() { return N * sizeof(T); }
+        const AllocStats &stats() const { return this->stats_; }
+
+    protected:
+        alignas(T) uint8_t slots_[N][sizeof(T)];
+        uint16_t next_free_[N];
+        uint16_t free_head_{0};
+        AllocStats stats_{};
+};
+
+// Counts heap allocation calls made on core 0 while a render-path scope was
+// active, including blocks freed again before the scope ends. Only
+// implemented on RP2040 with render_heap_allocations configured, where
+// newlib's _malloc_r is wrapped at link time; otherwise it never reports an
+// allocation.
+class HeapProbe {
+    public:
+        void begin();
+        void end();
+        uint32_t allocations() const { return this->allocations_; }
+
+    protected:
+        uint32_t start_calls_{0};
+        uint32_t allocations_{0};
+        uint8_t depth_{0};
+};
+
+class HeapProbeScope {
+    public:
+        explicit HeapProbeScope(HeapProbe *probe) : probe_(probe)
+        {
+            if (this->probe_ != nullptr)
+                this->probe_->begin();
+        }
+        ~HeapProbeScope()
+        {
+            if (this->probe_ != nullptr)
+                this->probe_->end();
+        }
+
+    protected:
+        HeapProbe *probe_;
+};
+
+}  // namespace picocalc
+}  // namespace esphome
@@ -0,0 +1,113 @@
+#include "burn_in.h"
+#include "esphome/core/hal.h"
+#include "esphome/core/log.h"
+
+namespace esphome
+{
+    namespace picocalc
+    {
+        static const char *const TAG = "picocalc.burn_in";
+
+        bool BurnIn::start()
+        {
+            if (this->panel_ == nullptr)
+                return false;
+            if (this->active_)
+                return true;
+            ESP_LOGI(TAG, "Starting burn-in protection");
+            this->active_ = true;
+            this->offset_ = 0;
+            this->direction_ = 1;
+            this->base_inverted_ = this->panel_->is_inverted();
+            this->base_madctl_ = this->panel_->madctl();
+            this->started_ms_ = this->last_shift_ms_ = this->last_invert_ms_ = millis();
+            this->start_bytes_ = this->panel_->bytes_sent();
+            this->start_time_us_ = this->panel_->time_spent_us();
+            // The whole panel becomes one scroll area, so lines wrap around as it moves.
+            this->panel_->set_scroll_margins(0, 0);
+            return true;
+        }
+
+        void BurnIn::stop()
+        {
+            if (!this->active_)
+                return;
+            this->panel_->scroll_to(0);
+            if (this->panel_->is_inverted() != this->base_inverted_)
+                this->panel_->set_inverted(this->base_inverted_);
+            if (this->panel_->madctl() != this->base_madctl_)
+                this->panel_->set_madctl(this->base_madctl_);
+            this->publish_();
+            this->active_ = false;
+            ESP_LOGI(TAG, "Stopped burn-in protection after %u s", (unsigned) ((millis() - this->started_ms_) / 1000));
+        }
+
+        void BurnIn::loop()
+        {
+            if (!this->active_)
+                return;
+            uint32_t now = millis();
+            if (now - this->last_shift_ms_ >= this->shift_interval_)
+            {
+                this->last_shift_ms_ = now;
+                this->shift_();
+                this->publish_();
+            }
+            if (this->invert_interval_ != 0 && now - this->last_invert_ms_ >= this->invert_interval_)
+            {
+                this->last_invert_ms_ = now;
+                this->panel_->set_inverted(!this->panel_->is_inverted());
+            }
+        }
+
+        void BurnIn::shift_()
+        {
+            // Walk back and forth between -max_offset and +max_offset.
+            if (this->max_offset_ != 0)
+            {
+                if (this->offset_ + this->direction_ > int16_t(this->max_offset_) ||
+                    this->offset_ + this->direction_ < -int16_t(this->max_offset_))
+                    this->direction_ = -this->direction_;
+                this->offset_ += this->direction_;
+            }
+            uint16_t height = this->panel_->height();
+            this->panel_->scroll_to((this->offset_ + height) % height);
+
+            // Alternate the scan direction every time the offset passes zero.
+            if (this->refresh_order_ && this->offset_ == 0)
+                this->panel_->set_madctl(this->panel_->madctl() ^ (PANEL_MADCTL_ML | PANEL_MADCTL_MH));
+        }
+
+        void BurnIn::publish_()
+        {
+            uint32_t elapsed_ms = millis() - this->started_ms_;
+            uint32_t bytes = this->panel_->bytes_sent() - this->start_bytes_;
+            uint32_t time_us = this->panel_->time_spent_us() - this->start_time_us_;
+            uint64_t frame_bytes = uint64_t(this->panel_->width()) * this->panel_->height() * 2;
+            uint64_t baseline = frame_bytes * (elapsed_ms / this->baseline_frame_interval_);
+            float saved = baseline > bytes ? float(baseline - bytes) : 0.0f;
+            ESP_LOGD(TAG, "Offset %d: %u B in %u us so far, ~%.0f B saved against full-frame snow", this->offset_,
+                     (unsigned) bytes, (unsigned) time_us, saved);
+            if (this->bus_bytes_sensor_ != nullptr)
+                this->bus_bytes_sensor_->publish_state(bytes);
+            if (this->bus_bytes_saved_estimate_sensor_ != nullptr)
+                this->bus_bytes_saved_estimate_sensor_->publish_state(saved);
+            if (this->cpu_time_sensor_ != nullptr)
+                this->cpu_time_sensor_->publish_state(time_us);
+        }
+
+        void BurnIn::dump_config(const char *tag)
+        {
+            ESP_LOGCONFIG(tag, "  Burn-in shift interval: %u ms, max offset %u px", (unsigned) this->shift_interval_,
+                          (unsigned) this->max_offset_);
+            if (this->invert_interval_ != 0)
+                ESP_LOGCONFIG(tag, "  Burn-in invert interval: %u ms", (unsigned) this->invert_interval_);
+            ESP_LOGCONFIG(tag, "  Burn-in refresh order flips: %s", this->refresh_order_ ? "yes" : "no");
+            if (this->panel_ == nullptr)
+                ESP_LOGW(tag, "  Burn-in has no panel to drive");
+            LOG_SENSOR("  ", "Burn-in bus bytes", this->bus_bytes_sensor_);
+            LOG_SENSOR("  ", "Burn-in bus bytes saved (estimate)", this->bus_bytes_saved_estimate_sensor_);
+            LOG_SENSOR("  ", "Burn-in CPU time", this->cpu_time_sensor_);
+        }
+    } // namespace picocalc
+} // namespace esphome
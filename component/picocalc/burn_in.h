@@ -0,0 +1,59 @@
+#pragma once
+#include <cstdint>
+#include "esphome/components/sensor/sensor.h"
+#include "panel.h"
+
+namespace esphome {
+namespace picocalc {
+
+// Burn-in protection that moves the picture with the controller's vertical
+// scroll offset and optionally flips inversion and refresh order, instead of
+// rendering full-screen noise. Each step is a few register writes.
+class BurnIn {
+    public:
+        void set_panel(Panel *panel) { this->panel_ = panel; }
+        void set_shift_interval(uint32_t interval) { this->shift_interval_ = interval; }
+        void set_max_offset(uint16_t max_offset) { this->max_offset_ = max_offset; }
+        void set_invert_interval(uint32_t interval) { this->invert_interval_ = interval; }
+        void set_refresh_order(bool refresh_order) { this->refresh_order_ = refresh_order; }
+        // Frame period of the full-screen snow this replaces, used for the savings estimate.
+        void set_baseline_frame_interval(uint32_t interval) { this->baseline_frame_interval_ = interval; }
+        void set_bus_bytes_sensor(sensor::Sensor *sensor) { this->bus_bytes_sensor_ = sensor; }
+        void set_bus_bytes_saved_estimate_sensor(sensor::Sensor *sensor) { this->bus_bytes_saved_estimate_sensor_ = sensor; }
+        void set_cpu_time_sensor(sensor::Sensor *sensor) { this->cpu_time_sensor_ = sensor; }
+
+        bool start();
+        void stop();
+        bool is_active() const { return this->active_; }
+        void loop();
+        void dump_config(const char *tag);
+
+    protected:
+        void shift_();
+        void publish_();
+
+        Panel *panel_{nullptr};
+        uint32_t shift_interval_{60000};
+        uint16_t max_offset_{8};
+        uint32_t invert_interval_{0};
+        bool refresh_order_{false};
+        uint32_t baseline_frame_interval_{100};
+
+        bool active_{false};
+        int16_t offset_{0};
+        int8_t direction_{1};
+        bool base_inverted_{true};
+        uint8_t base_madctl_{0};
+        uint32_t started_ms_{0};
+        uint32_t last_shift_ms_{0};
+        uint32_t last_invert_ms_{0};
+        uint32_t start_bytes_{0};
+        uint32_t start_time_us_{0};
+
+        sensor::Sensor *bus_bytes_sensor_{nullptr};
+        sensor::Sensor *bus_bytes_saved_estimate_sensor_{nullptr};
+        sensor::Sensor *cpu_time_sensor_{nullptr};
+};
+
+}  // namespace picocalc
+}  // namespace esphome
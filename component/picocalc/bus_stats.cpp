@@ -0,0 +1,106 @@
+#include "bus_stats.h"
+
+#ifdef USE_PICOCALC_BUS_STATS
+
+#include <cstring>
+#include "esphome/core/hal.h"
+#include "esphome/core/log.h"
+
+namespace esphome
+{
+    namespace picocalc
+    {
+        BusStats global_bus_stats;  // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+
+        static const uint8_t CMD_CASET = 0x2A;
+        static const uint8_t CMD_PASET = 0x2B;
+        static const uint8_t CMD_RAMWR = 0x2C;
+        static const uint8_t TOP_OPCODES = 4;
+
+        void BusStats::command(uint8_t opcode, uint32_t data_bytes)
+        {
+            this->opcodes_[opcode]++;
+            this->current_.commands++;
+            this->current_.data_bytes += data_bytes;
+        }
+
+        void BusStats::window(bool column_changed, bool row_changed, uint16_t w, uint16_t h)
+        {
+            if (column_changed)
+                this->command(CMD_CASET, 4);
+            if (row_changed)
+                this->command(CMD_PASET, 4);
+            this->command(CMD_RAMWR, 2u * w * h);
+            this->current_.windows++;
+        }
+
+        void BusStats::begin_transfer()
+        {
+            if (this->transfer_depth_++ == 0)
+            {
+                this->transfer_start_ = micros();
+                this->current_.cs_toggles++;
+            }
+        }
+
+        void BusStats::end_transfer()
+        {
+            if (this->transfer_depth_ == 0)
+                return;
+            if (--this->transfer_depth_ == 0)
+                this->current_.busy_us += micros() - this->transfer_start_;
+        }
+
+        void BusStats::end_frame()
+        {
+            this->last_ = this->current_;
+            this->period_.commands += this->current_.commands;
+            this->period_.data_bytes += this->current_.data_bytes;
+            this->period_.windows += this->current_.windows;
+            this->period_.cs_toggles += this->current_.cs_toggles;
+            this->period_.busy_us += this->current_.busy_us;
+            this->period_frames_++;
+            this->total_frames_++;
+            this->current_ = BusFrame{};
+        }
+
+        void BusStats::reset_period()
+        {
+            this->period_ = BusFrame{};
+            this->period_frames_ = 0;
+            memset(this->opcodes_, 0, sizeof(this->opcodes_));
+        }
+
+        void BusStats::log_summary(const char *tag) const
+        {
+            uint32_t frames = this->period_frames_ ? this->period_frames_ : 1;
+            ESP_LOGD(tag, "Bus: %u frames, per frame %u cmds, %u bytes, %u windows, %u CS, %u us busy",
+                     (unsigned) this->period_frames_, (unsigned) (this->period_.commands / frames),
+                     (unsigned) (this->period_.data_bytes / frames), (unsigned) (this->period_.windows / frames),
+                     (unsigned) (this->period_.cs_toggles / frames), (unsigned) (this->period_.busy_us / frames));
+
+            // Busiest opcodes of the period, selected without sorting the full table.
+            uint8_t top[TOP_OPCODES] = {};
+            uint8_t found = 0;
+            for (uint16_t op = 0; op < 256; op++)
+            {
+                uint32_t count = this->opcodes_[op];
+                if (count == 0)
+                    continue;
+                uint8_t pos = found < TOP_OPCODES ? found++ : TOP_OPCODES;
+                while (pos > 0 && this->opcodes_[top[pos - 1]] < count)
+                {
+                    if (pos < TOP_OPCODES)
+                        top[pos] = top[pos - 1];
+                    pos--;
+                }
+                if (pos < TOP_OPCODES)
+                    top[pos] = op;
+            }
+            for (uint8_t i = 0; i < found; i++)
+                ESP_LOGD(tag, "  opcode 0x%02X: %u", top[i], (unsigned) this->opcodes_[top[i]]);
+        }
+    } // namespace picocalc
+} // namespace esphome
+
+#endif  // USE_PICOCALC_BUS_STATS
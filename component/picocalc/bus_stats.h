@@ -0,0 +1,69 @@
+#pragma once
+#include <cstdint>
+#include "esphome/core/defines.h"
+
+namespace esphome {
+namespace picocalc {
+
+// Counters for one display frame. A frame is whatever the renderer calls it:
+// AdafruitGfx closes one per loop() pass.
+struct BusFrame {
+    uint32_t commands{0};
+    uint32_t data_bytes{0};
+    uint32_t windows{0};
+    uint32_t cs_toggles{0};
+    uint32_t busy_us{0};
+};
+
+class BusStats {
+    public:
+        // A command and its parameters; the transaction around it is counted by begin/end_transfer().
+        void command(uint8_t opcode, uint32_t data_bytes);
+        // CASET/PASET/RAMWR for a w*h window; the RGB565 payload is accounted as 2*w*h.
+        void window(bool column_changed, bool row_changed, uint16_t w, uint16_t h);
+        void begin_transfer();
+        void end_transfer();
+        void end_frame();
+
+        const BusFrame &last_frame() const { return this->last_; }
+        // Sum over every frame closed since the last reset_period().
+        const BusFrame &period() const { return this->period_; }
+        uint32_t period_frames() const { return this->period_frames_; }
+        uint32_t opcode_count(uint8_t opcode) const { return this->opcodes_[opcode]; }
+        uint32_t total_frames() const { return this->total_frames_; }
+
+        void log_summary(const char *tag) const;
+        void reset_period();
+
+    protected:
+        BusFrame current_{};
+        BusFrame last_{};
+        BusFrame period_{};
+        uint32_t period_frames_{0};
+        uint32_t total_frames_{0};
+        uint32_t opcodes_[256]{};
+        uint32_t transfer_start_{0};
+        uint8_t transfer_depth_{0};
+};
+
+#ifdef USE_PICOCALC_BUS_STATS
+extern BusStats global_bus_stats;  // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+#endif
+
+}  // namespace picocalc
+}  // namespace esphome
+
+// Hooks for the display drivers. They expand to nothing unless bus_stats is configured.
+#ifdef USE_PICOCALC_BUS_STATS
+#define PICOCALC_BUS_COMMAND(op, n) esphome::picocalc::global_bus_stats.command((op), (n))
+#define PICOCALC_BUS_WINDOW(cx, cy, w, h) esphome::picocalc::global_bus_stats.window((cx), (cy), (w), (h))
+#define PICOCALC_BUS_BEGIN() esphome::picocalc::global_bus_stats.begin_transfer()
+#define PICOCALC_BUS_END() esphome::picocalc::global_bus_stats.end_transfer()
+#define PICOCALC_BUS_FRAME() esphome::picocalc::global_bus_stats.end_frame()
+#else
+#define PICOCALC_BUS_COMMAND(op, n)
+#define PICOCALC_BUS_WINDOW(cx, cy, w, h)
+#define PICOCALC_BUS_BEGIN()
+#define PICOCALC_BUS_END()
+#define PICOCALC_BUS_FRAME()
+#endif
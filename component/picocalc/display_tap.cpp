@@ -0,0 +1,81 @@
+#include "display_tap.h"
+
+#ifdef USE_LVGL
+
+#include <algorithm>
+#include "esphome/core/log.h"
+
+namespace esphome
+{
+    namespace picocalc
+    {
+        static const char *const TAG = "picocalc.display_tap";
+
+        // LVGL's callbacks carry no context of ours, and there is only one display.
+        static DisplayTap *active_tap = nullptr;
+
+        void DisplayTap::add_listener(FrameListener *listener)
+        {
+            if (this->listener_count_ < DISPLAY_TAP_LISTENERS)
+                this->listeners_[this->listener_count_++] = listener;
+        }
+
+        void DisplayTap::request_shadow(uint16_t slot_size)
+        {
+            this->shadow_slot_size_ = std::max(this->shadow_slot_size_, slot_size);
+        }
+
+        void DisplayTap::loop()
+        {
+            if (this->disp_ != nullptr || (this->listener_count_ == 0 && this->shadow_slot_size_ == 0 && !this->refresh_hook_))
+                return;
+            lv_disp_t *disp = lv_disp_get_default();
+            if (disp == nullptr || disp->driver->flush_cb == nullptr || disp->refr_timer == nullptr || active_tap != nullptr)
+                return;
+            if (this->shadow_slot_size_ != 0 &&
+                !this->shadow_.init(lv_disp_get_hor_res(disp), lv_disp_get_ver_res(disp), this->shadow_slot_size_))
+                ESP_LOGW(TAG, "No memory for the screen shadow");
+            active_tap = this;
+            this->disp_ = disp;
+            this->original_flush_ = disp->driver->flush_cb;
+            disp->driver->flush_cb = flush_;
+            this->original_refresh_ = disp->refr_timer->timer_cb;
+            disp->refr_timer->timer_cb = refresh_;
+            ESP_LOGD(TAG, "Installed with %u listeners, shadow %u B", (unsigned) this->listener_count_,
+                     (unsigned) (this->shadow_.is_ready() ? this->shadow_.storage_size() : 0));
+        }
+
+        void DisplayTap::refresh_(lv_timer_t *timer)
+        {
+            DisplayTap *tap = active_tap;
+            HeapProbeScope probe(tap->heap_probe_);
+            if (tap->refresh_hook_)
+                tap->refresh_hook_();
+            for (uint8_t i = 0; i < tap->listener_count_; i++)
+                tap->listeners_[i]->on_refresh(tap->disp_);
+            tap->original_refresh_(timer);
+        }
+
+        void DisplayTap::flush_(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *pixels)
+        {
+            DisplayTap *tap = active_tap;
+            bool last = lv_disp_flush_is_last(drv);
+            tap->shadow_.patch(*area, pixels);
+            for (uint8_t i = 0; i < tap->listener_count_; i++)
+                tap->listeners_[i]->on_flush(*area, pixels, last);
+            if (last)
+                tap->frames_++;
+            tap->original_flush_(drv, area, pixels);
+            for (uint8_t i = 0; i < tap->listener_count_; i++)
+                tap->listeners_[i]->on_flushed(*area, last);
+        }
+
+        void DisplayTap::blit(const lv_area_t &area, const uint16_t *pixels)
+        {
+            // The driver only reads the pixels; LVGL's signature just is not const.
+            this->original_flush_(this->disp_->driver, &area, reinterpret_cast<lv_color_t *>(const_cast<uint16_t *>(pixels)));
+        }
+    } // namespace picocalc
+} // namespace esphome
+
+#endif  // USE_LVGL
@@ -0,0 +1,68 @@
+#pragma once
+#include "esphome/core/defines.h"
+
+#ifdef USE_LVGL
+#include <cstdint>
+#include <functional>
+#include <lvgl.h>
+#include "arena.h"
+#include "screen_shadow.h"
+
+namespace esphome {
+namespace picocalc {
+
+static const uint8_t DISPLAY_TAP_LISTENERS = 6;
+
+class FrameListener {
+    public:
+        // Right before LVGL renders what is invalid; the invalid areas may still be changed here.
+        virtual void on_refresh(lv_disp_t *disp) {}
+        // For every flushed area, before the pixels reach the panel. `last` marks the end of a frame.
+        virtual void on_flush(const lv_area_t &area, const lv_color_t *pixels, bool last) {}
+        // After the display driver has returned from writing the area out.
+        virtual void on_flushed(const lv_area_t &area, bool last) {}
+};
+
+// Sits between LVGL and the display driver: wraps the default display's
+// flush callback and refresh timer, keeps the optional screen shadow up to
+// date and tells listeners about every frame.
+class DisplayTap {
+    public:
+        void add_listener(FrameListener *listener);
+        // The shadow is allocated when the tap is installed, with the largest slot size requested.
+        void request_shadow(uint16_t slot_size);
+        // Runs at the start of every refresh timer pass, ahead of the listeners,
+        // so widget changes made here are rendered in the same frame.
+        void set_refresh_hook(std::function<void()> &&hook) { this->refresh_hook_ = std::move(hook); }
+        // Every refresh timer pass, render and flush included, runs inside a scope of this probe.
+        void set_heap_probe(HeapProbe *probe) { this->heap_probe_ = probe; }
+        // Installs the tap once LVGL has created its display; called every loop until then.
+        void loop();
+
+        bool is_installed() const { return this->disp_ != nullptr; }
+        lv_disp_t *get_disp() { return this->disp_; }
+        ScreenShadow *get_shadow() { return this->shadow_.is_ready() ? &this->shadow_ : nullptr; }
+        // Sends pixels straight to the display driver, bypassing the shadow and the listeners.
+        void blit(const lv_area_t &area, const uint16_t *pixels);
+        uint32_t frames() const { return this->frames_; }
+
+    protected:
+        static void flush_(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *pixels);
+        static void refresh_(lv_timer_t *timer);
+
+        lv_disp_t *disp_{nullptr};
+        void (*original_flush_)(lv_disp_drv_t *, const lv_area_t *, lv_color_t *){nullptr};
+        lv_timer_cb_t original_refresh_{nullptr};
+        std::function<void()> refresh_hook_;
+        HeapProbe *heap_probe_{nullptr};
+        FrameListener *listeners_[DISPLAY_TAP_LISTENERS]{};
+        uint8_t listener_count_{0};
+        uint16_t shadow_slot_size_{0};
+        ScreenShadow shadow_;
+        uint32_t frames_{0};
+};
+
+}  // namespace picocalc
+}  // namespace esphome
+
+#endif  // USE_LVGL
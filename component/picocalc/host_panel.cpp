@@ -0,0 +1,33 @@
+#include "host_panel.h"
+#include "esphome/core/hal.h"
+#include "esphome/core/log.h"
+
+namespace esphome
+{
+    namespace picocalc
+    {
+        static const char *const TAG = "picocalc.host_panel";
+        // CASET, PASET and RAMWR with their parameters, around every area.
+        static const uint32_t WINDOW_OVERHEAD_BYTES = 3 + 4 + 4;
+
+        void HostPanel::dump_config(const char *tag)
+        {
+            ESP_LOGCONFIG(tag, "  Host panel: %u kHz SPI", (unsigned) (this->spi_frequency_ / 1000));
+        }
+
+        void HostPanel::send_command(uint8_t command, const uint8_t *data, uint8_t length)
+        {
+            ESP_LOGV(TAG, "Command 0x%02X, %u bytes", command, length);
+        }
+
+#ifdef USE_LVGL
+        void HostPanel::on_flush(const lv_area_t &area, const lv_color_t *pixels, bool last)
+        {
+            uint32_t count = uint32_t(lv_area_get_width(&area)) * lv_area_get_height(&area);
+            uint64_t bits = uint64_t(count * 2 + WINDOW_OVERHEAD_BYTES) * 8;
+            this->pixels_written_ += count;
+            delayMicroseconds(uint32_t(bits * 1000000 / this->spi_frequency_));
+        }
+#endif
+    } // namespace picocalc
+} // namespace esphome
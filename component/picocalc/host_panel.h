@@ -0,0 +1,35 @@
+#pragma once
+#include "esphome/core/defines.h"
+#include <cstdint>
+#include "display_tap.h"
+#include "panel.h"
+
+namespace esphome {
+namespace picocalc {
+
+// Stand-in for the display controller when running on a host: register
+// commands are only logged, and every flushed area is held for as long as
+// its window and RGB565 RAMWR would take on SPI at spi_frequency, so frame
+// timing (and what the latency tracer sees) resembles the device.
+class HostPanel : public Panel
+#ifdef USE_LVGL
+    , public FrameListener
+#endif
+{
+    public:
+        void set_spi_frequency(uint32_t hz) { this->spi_frequency_ = hz; }
+        void send_command(uint8_t command, const uint8_t *data, uint8_t length) override;
+        void dump_config(const char *tag);
+
+#ifdef USE_LVGL
+        void on_flush(const lv_area_t &area, const lv_color_t *pixels, bool last) override;
+#endif
+        uint32_t pixels_written() const { return this->pixels_written_; }
+
+    protected:
+        uint32_t spi_frequency_{40000000};
+        uint32_t pixels_written_{0};
+};
+
+}  // namespace picocalc
+}  // namespace esphome
@@ -0,0 +1,155 @@
+#include "idle_manager.h"
+#include "esphome/core/hal.h"
+#include "esphome/core/log.h"
+
+namespace esphome
+{
+    namespace picocalc
+    {
+        static const char *const TAG = "picocalc.idle";
+
+        const char *idle_state_to_string(IdleState state)
+        {
+            switch (state)
+            {
+                case IDLE_STATE_ACTIVE: return "active";
+                case IDLE_STATE_DIM: return "dim";
+                case IDLE_STATE_IDLE: return "idle";
+                case IDLE_STATE_SLEEP: return "sleep";
+                default: return "unknown";
+            }
+        }
+
+        void IdleManager::dump_config(const char *tag)
+        {
+            ESP_LOGCONFIG(tag, "  Idle: dim after %u s at %.0f Hz, idle after %u s at %.0f Hz, sleep after %u s",
+                          (unsigned) (this->timeouts_[IDLE_STATE_DIM] / 1000), this->dim_frame_rate_,
+                          (unsigned) (this->timeouts_[IDLE_STATE_IDLE] / 1000), this->idle_frame_rate_,
+                          (unsigned) (this->timeouts_[IDLE_STATE_SLEEP] / 1000));
+            LOG_SENSOR("  ", "Active residency", this->residency_sensors_[IDLE_STATE_ACTIVE]);
+            LOG_SENSOR("  ", "Dim residency", this->residency_sensors_[IDLE_STATE_DIM]);
+            LOG_SENSOR("  ", "Idle residency", this->residency_sensors_[IDLE_STATE_IDLE]);
+            LOG_SENSOR("  ", "Sleep residency", this->residency_sensors_[IDLE_STATE_SLEEP]);
+        }
+
+        void IdleManager::notify_activity()
+        {
+            this->last_activity_ms_ = millis();
+            if (this->state_ == IDLE_STATE_ACTIVE)
+                return;
+            this->wake_();
+            if (this->panel_ != nullptr)
+                this->panel_->wait_awake();
+        }
+
+#ifdef USE_LVGL
+        void IdleManager::on_refresh(lv_disp_t *disp)
+        {
+            // Wake before LVGL renders, so the SLPOUT settle time is not spent inside a flush.
+            if (disp->inv_p != 0)
+                this->notify_activity();
+        }
+
+        void IdleManager::on_flush(const lv_area_t &area, const lv_color_t *pixels, bool last)
+        {
+            // Only for flushes without a refresh first, e.g. blits; no settle wait in here.
+            this->last_activity_ms_ = millis();
+            if (this->state_ != IDLE_STATE_ACTIVE)
+                this->wake_();
+        }
+#endif
+
+        void IdleManager::loop()
+        {
+            uint32_t now = millis();
+            if (this->period_start_ms_ == 0)
+                this->period_start_ms_ = this->state_since_ms_ = this->last_activity_ms_ = now;
+            uint32_t idle_for = now - this->last_activity_ms_;
+            for (uint8_t next = this->state_ + 1; next < IDLE_STATE_COUNT; next++)
+            {
+                if (this->timeouts_[next] != 0 && idle_for >= this->timeouts_[next])
+                    this->enter_(IdleState(next));
+            }
+            if (now - this->period_start_ms_ >= this->update_interval_)
+                this->publish_(now);
+        }
+
+        void IdleManager::account_(uint32_t now)
+        {
+            this->residency_ms_[this->state_] += now - this->state_since_ms_;
+            this->state_since_ms_ = now;
+        }
+
+        void IdleManager::enter_(IdleState state)
+        {
+            this->account_(millis());
+            ESP_LOGD(TAG, "Entering %s", idle_state_to_string(state));
+            switch (state)
+            {
+                case IDLE_STATE_DIM:
+                    if (this->panel_ != nullptr)
+                        this->panel_->set_frame_rate(this->dim_frame_rate_);
+                    if (this->display_ != nullptr)
+                    {
+                        this->display_update_interval_ = this->display_->get_update_interval();
+                        this->display_->set_update_interval(this->idle_update_interval_);
+                        this->display_->stop_poller();
+                        this->display_->start_poller();
+                    }
+                    break;
+                case IDLE_STATE_IDLE:
+                    if (this->panel_ != nullptr)
+                    {
+                        this->panel_->set_idle_frame_rate(this->idle_frame_rate_);
+                        this->panel_->set_idle_mode(true);
+                    }
+                    break;
+                case IDLE_STATE_SLEEP:
+                    // SLPIN too soon after a SLPOUT is refused; try again on the next loop.
+                    if (this->panel_ != nullptr && !this->panel_->set_sleep(true))
+                        return;
+                    break;
+                default:
+                    break;
+            }
+            this->state_ = state;
+        }
+
+        void IdleManager::wake_()
+        {
+            this->account_(millis());
+            // The interface keeps working in sleep, so SLPOUT goes last and no
+            // command has to wait for it to settle.
+            if (this->state_ >= IDLE_STATE_IDLE && this->panel_ != nullptr)
+                this->panel_->set_idle_mode(false);
+            if (this->state_ >= IDLE_STATE_DIM)
+            {
+                if (this->panel_ != nullptr)
+                    this->panel_->restore_frame_rate();
+                if (this->display_ != nullptr && this->display_update_interval_ != 0)
+                {
+                    this->display_->set_update_interval(this->display_update_interval_);
+                    this->display_->stop_poller();
+                    this->display_->start_poller();
+                }
+            }
+            if (this->state_ >= IDLE_STATE_SLEEP && this->panel_ != nullptr)
+                this->panel_->set_sleep(false);
+            ESP_LOGD(TAG, "Woke up from %s", idle_state_to_string(this->state_));
+            this->state_ = IDLE_STATE_ACTIVE;
+        }
+
+        void IdleManager::publish_(uint32_t now)
+        {
+            this->account_(now);
+            uint32_t period = now - this->period_start_ms_;
+            for (uint8_t state = 0; state < IDLE_STATE_COUNT; state++)
+            {
+                if (this->residency_sensors_[state] != nullptr && period != 0)
+                    this->residency_sensors_[state]->publish_state(100.0f * this->residency_ms_[state] / period);
+                this->residency_ms_[state] = 0;
+            }
+            this->period_start_ms_ = now;
+        }
+    } // namespace picocalc
+} // namespace esphome
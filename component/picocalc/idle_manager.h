@@ -0,0 +1,86 @@
+#pragma once
+#include "esphome/core/defines.h"
+#include <cstdint>
+#include "esphome/core/component.h"
+#include "esphome/components/sensor/sensor.h"
+#include "display_tap.h"
+#include "panel.h"
+
+namespace esphome {
+namespace picocalc {
+
+enum IdleState : uint8_t {
+    IDLE_STATE_ACTIVE = 0,
+    IDLE_STATE_DIM,
+    IDLE_STATE_IDLE,
+    IDLE_STATE_SLEEP,
+    IDLE_STATE_COUNT,
+};
+
+const char *idle_state_to_string(IdleState state);
+
+// Steps the panel and the MCU down while nothing happens: a lower frame rate
+// (FRMCTR1) after dim_after, 8-colour idle mode at the FRMCTR2 rate after
+// idle_after, SLPIN after sleep_after. The MCU clocks are left alone, so I2C,
+// PIO and PWM keep their rates. A key or a flushed frame brings everything
+// back before that frame reaches the panel.
+class IdleManager
+#ifdef USE_LVGL
+    : public FrameListener
+#endif
+{
+    public:
+        // The panel's poller, if any, gets its update interval stretched while not active.
+        void set_panel(Panel *panel)
+        {
+            this->panel_ = panel;
+            this->display_ = panel != nullptr ? panel->poller() : nullptr;
+        }
+        void set_timeout(IdleState state, uint32_t timeout) { this->timeouts_[state] = timeout; }
+        void set_dim_frame_rate(float hz) { this->dim_frame_rate_ = hz; }
+        void set_idle_frame_rate(float hz) { this->idle_frame_rate_ = hz; }
+        void set_idle_update_interval(uint32_t interval) { this->idle_update_interval_ = interval; }
+        void set_update_interval(uint32_t interval) { this->update_interval_ = interval; }
+        void set_residency_sensor(IdleState state, sensor::Sensor *sensor) { this->residency_sensors_[state] = sensor; }
+        void set_active_residency_sensor(sensor::Sensor *sensor) { this->set_residency_sensor(IDLE_STATE_ACTIVE, sensor); }
+        void set_dim_residency_sensor(sensor::Sensor *sensor) { this->set_residency_sensor(IDLE_STATE_DIM, sensor); }
+        void set_idle_residency_sensor(sensor::Sensor *sensor) { this->set_residency_sensor(IDLE_STATE_IDLE, sensor); }
+        void set_sleep_residency_sensor(sensor::Sensor *sensor) { this->set_residency_sensor(IDLE_STATE_SLEEP, sensor); }
+
+        // Wakes everything up and waits out the panel's SLPOUT settle time; not for flush callbacks.
+        void notify_activity();
+        void loop();
+        void dump_config(const char *tag);
+        IdleState state() const { return this->state_; }
+
+#ifdef USE_LVGL
+        void on_refresh(lv_disp_t *disp) override;
+        void on_flush(const lv_area_t &area, const lv_color_t *pixels, bool last) override;
+#endif
+
+    protected:
+        void enter_(IdleState state);
+        void wake_();
+        void account_(uint32_t now);
+        void publish_(uint32_t now);
+
+        Panel *panel_{nullptr};
+        PollingComponent *display_{nullptr};
+        // Idle time before each state is entered; 0 skips the state.
+        uint32_t timeouts_[IDLE_STATE_COUNT]{0, 30000, 120000, 600000};
+        float dim_frame_rate_{30.0f};
+        float idle_frame_rate_{15.0f};
+        uint32_t idle_update_interval_{1000};
+        uint32_t update_interval_{60000};
+
+        IdleState state_{IDLE_STATE_ACTIVE};
+        uint32_t last_activity_ms_{0};
+        uint32_t state_since_ms_{0};
+        uint32_t period_start_ms_{0};
+        uint32_t residency_ms_[IDLE_STATE_COUNT]{};
+        uint32_t display_update_interval_{0};
+        sensor::Sensor *residency_sensors_[IDLE_STATE_COUNT]{};
+};
+
+}  // namespace picocalc
+}  // namespace esphome
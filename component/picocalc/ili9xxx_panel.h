@@ -0,0 +1,29 @@
+#pragma once
+#include "esphome/core/defines.h"
+
+#ifdef USE_PICOCALC_ILI9XXX
+#include "esphome/components/ili9xxx/ili9xxx_display.h"
+#include "panel.h"
+
+namespace esphome {
+namespace picocalc {
+
+// Panel commands for the stock ESPHome ili9xxx display used by the LVGL setup.
+class Ili9xxxPanel : public Panel {
+    public:
+        explicit Ili9xxxPanel(ili9xxx::ILI9XXXDisplay *display) : display_(display) {}
+
+        void send_command(uint8_t command, const uint8_t *data, uint8_t length) override
+        {
+            this->display_->send_command(command, data, length);
+        }
+        PollingComponent *poller() override { return this->display_; }
+
+    protected:
+        ili9xxx::ILI9XXXDisplay *display_;
+};
+
+}  // namespace picocalc
+}  // namespace esphome
+
+#endif  // USE_PICOCALC_ILI9XXX
@@ -0,0 +1,74 @@
+#include "keyboard.h"
+
+#ifdef USE_PICOCALC_KEYBOARD
+
+#include "esphome/core/hal.h"
+
+namespace esphome
+{
+    namespace picocalc
+    {
+        static const uint8_t REG_KEY_STATUS = 0x04;
+        static const uint8_t REG_FIFO = 0x09;
+        static const uint8_t KEY_COUNT_MASK = 0x1F;
+        // Bounds the time spent on the slow bus in one pass; the rest waits for the next poll.
+        static const uint8_t MAX_EVENTS_PER_POLL = 8;
+
+        void KeySource::emit_(uint8_t key, uint8_t state, uint32_t read_us)
+        {
+            if (this->input_hook_)
+                this->input_hook_(key, state, read_us);
+            this->key_callback_.call(key, state);
+        }
+
+#ifdef USE_PICOCALC_KEYBOARD_I2C
+        uint8_t Keyboard::poll()
+        {
+            uint32_t read_us = micros();
+            uint8_t status;
+            if (this->read_register(REG_KEY_STATUS, &status, 1) != i2c::ERROR_OK)
+            {
+                this->errors_++;
+                return 0;
+            }
+            uint8_t count = status & KEY_COUNT_MASK;
+            uint8_t handled = 0;
+            for (; handled < count && handled < MAX_EVENTS_PER_POLL; handled++)
+            {
+                uint8_t event[2];
+                if (this->read_register(REG_FIFO, event, sizeof(event)) != i2c::ERROR_OK)
+                {
+                    this->errors_++;
+                    break;
+                }
+                if (event[1] != 0)
+                    this->emit_(event[1], event[0], read_us);
+            }
+            return handled;
+        }
+#endif
+
+        uint8_t ScriptedKeyboard::poll()
+        {
+            uint32_t read_us = micros();
+            if (this->read_delay_us_ != 0)
+                delayMicroseconds(this->read_delay_us_);
+            uint32_t now = millis();
+            if (this->script_[0] == 0 || now - this->last_key_ms_ < this->key_interval_)
+                return 0;
+            if (this->script_[this->position_] == 0)
+            {
+                if (!this->repeat_)
+                    return 0;
+                this->position_ = 0;
+            }
+            this->last_key_ms_ = now;
+            uint8_t key = this->script_[this->position_++];
+            this->emit_(key, KEY_PRESSED, read_us);
+            this->emit_(key, KEY_RELEASED, read_us);
+            return 2;
+        }
+    } // namespace picocalc
+} // namespace esphome
+
+#endif  // USE_PICOCALC_KEYBOARD
@@ -0,0 +1,89 @@
+#pragma once
+#include "esphome/core/defines.h"
+
+#ifdef USE_PICOCALC_KEYBOARD
+#include <cstdint>
+#include <functional>
+#include "esphome/core/automation.h"
+#include "esphome/core/helpers.h"
+#ifdef USE_PICOCALC_KEYBOARD_I2C
+#include "esphome/components/i2c/i2c.h"
+#endif
+
+namespace esphome {
+namespace picocalc {
+
+static const uint8_t KEY_PRESSED = 1;
+static const uint8_t KEY_HOLD = 2;
+static const uint8_t KEY_RELEASED = 3;
+
+// Where key events come from: the real keyboard controller or a scripted
+// stand-in. picocalc polls it every poll_interval.
+class KeySource {
+    public:
+        void set_poll_interval(uint32_t interval) { this->poll_interval_ = interval; }
+        uint32_t poll_interval() const { return this->poll_interval_; }
+        // Runs before the callbacks, with the micros() at which the poll began.
+        void set_input_hook(std::function<void(uint8_t key, uint8_t state, uint32_t read_us)> &&hook)
+        {
+            this->input_hook_ = std::move(hook);
+        }
+        void add_on_key_callback(std::function<void(uint8_t key, uint8_t state)> &&callback)
+        {
+            this->key_callback_.add(std::move(callback));
+        }
+
+        // Reads every queued event and hands it to the callbacks; returns how many there were.
+        virtual uint8_t poll() = 0;
+        uint32_t errors() const { return this->errors_; }
+
+    protected:
+        void emit_(uint8_t key, uint8_t state, uint32_t read_us);
+
+        uint32_t poll_interval_{50};
+        uint32_t errors_{0};
+        std::function<void(uint8_t, uint8_t, uint32_t)> input_hook_;
+        CallbackManager<void(uint8_t, uint8_t)> key_callback_;
+};
+
+#ifdef USE_PICOCALC_KEYBOARD_I2C
+// The PicoCalc keyboard controller on I2C: register 0x04 holds the number of
+// queued key events, register 0x09 pops one as (state, key).
+class Keyboard : public KeySource, public i2c::I2CDevice {
+    public:
+        uint8_t poll() override;
+};
+#endif
+
+// Stand-in for the keyboard controller on hosts without one: presses and
+// releases the characters of `script` one per key_interval, and can hold each
+// poll for read_delay to model the time the I2C reads take.
+class ScriptedKeyboard : public KeySource {
+    public:
+        void set_script(const char *script) { this->script_ = script; }
+        void set_key_interval(uint32_t interval) { this->key_interval_ = interval; }
+        void set_read_delay(uint32_t delay_us) { this->read_delay_us_ = delay_us; }
+        void set_repeat(bool repeat) { this->repeat_ = repeat; }
+        uint8_t poll() override;
+
+    protected:
+        const char *script_{""};
+        uint32_t key_interval_{250};
+        uint32_t read_delay_us_{0};
+        bool repeat_{true};
+        uint16_t position_{0};
+        uint32_t last_key_ms_{0};
+};
+
+class KeyTrigger : public Trigger<uint8_t, uint8_t> {
+    public:
+        explicit KeyTrigger(KeySource *source)
+        {
+            source->add_on_key_callback([this](uint8_t key, uint8_t state) { this->trigger(key, state); });
+        }
+};
+
+}  // namespace picocalc
+}  // namespace esphome
+
+#endif  // USE_PICOCALC_KEYBOARD
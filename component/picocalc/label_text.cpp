@@ -0,0 +1,66 @@
+#include "label_text.h"
+
+#ifdef USE_LVGL
+
+#include <cstdio>
+#include <cstring>
+
+namespace esphome
+{
+    namespace picocalc
+    {
+        uint8_t LabelTextCache::slot_for(lv_obj_t *label)
+        {
+            uint8_t slot = this->find(label);
+            if (slot != LABEL_NO_SLOT)
+                return slot;
+            LabelText *entry = this->pool_.create(label);
+            if (entry == nullptr)
+                return LABEL_NO_SLOT;
+            this->entries_[this->count_] = entry;
+            return this->count_++;
+        }
+
+        uint8_t LabelTextCache::find(const lv_obj_t *label) const
+        {
+            for (uint8_t i = 0; i < this->count_; i++)
+            {
+                if (this->entries_[i]->label == label)
+                    return i;
+            }
+            return LABEL_NO_SLOT;
+        }
+
+        bool LabelTextCache::shows(uint8_t slot, const char *text) const
+        {
+            const LabelText *entry = this->entries_[slot];
+            return strcmp(entry->text, text) == 0 && lv_label_get_text(entry->label) == entry->text;
+        }
+
+        bool LabelTextCache::set(uint8_t slot, const char *text)
+        {
+            if (this->shows(slot, text))
+                return false;
+            LabelText *entry = this->entries_[slot];
+            strncpy(entry->text, text, sizeof(entry->text) - 1);
+            entry->text[sizeof(entry->text) - 1] = '\0';
+            lv_label_set_text_static(entry->label, entry->text);
+            return true;
+        }
+
+        bool LabelTextCache::set_unmanaged(lv_obj_t *label, const char *text)
+        {
+            if (strcmp(lv_label_get_text(label), text) == 0)
+                return false;
+            lv_label_set_text(label, text);
+            return true;
+        }
+
+        void format_label_text(char (&out)[LABEL_TEXT_SIZE], const char *fmt, va_list args)
+        {
+            vsnprintf(out, sizeof(out), fmt, args);
+        }
+    } // namespace picocalc
+} // namespace esphome
+
+#endif  // USE_LVGL
@@ -0,0 +1,61 @@
+#pragma once
+#include "esphome/core/defines.h"
+
+#ifdef USE_LVGL
+#include <cstdarg>
+#include <lvgl.h>
+#include "arena.h"
+
+#ifndef PICOCALC_LABEL_SLOTS
+#define PICOCALC_LABEL_SLOTS 8
+#endif
+
+namespace esphome {
+namespace picocalc {
+
+static const uint8_t LABEL_TEXT_SIZE = 48;
+static const uint8_t LABEL_NO_SLOT = 0xFF;
+
+// Text owned by us and handed to LVGL with lv_label_set_text_static(), so a
+// label update never reallocates inside LVGL.
+struct LabelText {
+    explicit LabelText(lv_obj_t *label) : label(label) { this->text[0] = '\0'; }
+
+    lv_obj_t *label;
+    char text[LABEL_TEXT_SIZE];
+};
+
+// One LabelText per label, addressed by slot. Slots are handed out in order
+// of first use and never given back, so callers can keep per-slot state.
+class LabelTextCache {
+    public:
+        // Slot of `label`, taking a free one on first use; LABEL_NO_SLOT once the pool is exhausted.
+        uint8_t slot_for(lv_obj_t *label);
+        // LABEL_NO_SLOT when `label` has no slot.
+        uint8_t find(const lv_obj_t *label) const;
+        uint8_t count() const { return this->count_; }
+        lv_obj_t *label(uint8_t slot) const { return this->entries_[slot]->label; }
+
+        // Whether LVGL already shows `text` out of the slot's buffer.
+        bool shows(uint8_t slot, const char *text) const;
+        // Returns true when the label text changed and LVGL was told about it.
+        bool set(uint8_t slot, const char *text);
+        // For labels without a slot: LVGL keeps its own copy, at the cost of a heap allocation.
+        static bool set_unmanaged(lv_obj_t *label, const char *text);
+
+        const AllocStats &stats() const { return this->pool_.stats(); }
+        static constexpr size_t storage_size() { return PICOCALC_LABEL_SLOTS * sizeof(LabelText); }
+
+    protected:
+        ObjectPool<LabelText, PICOCALC_LABEL_SLOTS> pool_;
+        LabelText *entries_[PICOCALC_LABEL_SLOTS]{};
+        uint8_t count_{0};
+};
+
+// vsnprintf into a label-sized buffer, truncating what does not fit.
+void format_label_text(char (&out)[LABEL_TEXT_SIZE], const char *fmt, va_list args);
+
+}  // namespace picocalc
+}  // namespace esphome
+
+#endif  // USE_LVGL
@@ -0,0 +1,172 @@
+#include "latency_trace.h"
+#include <algorithm>
+#include "esphome/core/hal.h"
+#include "esphome/core/log.h"
+
+namespace esphome
+{
+    namespace picocalc
+    {
+        static const char *const TAG = "picocalc.latency";
+
+        void LatencyTracer::dump_config(const char *tag)
+        {
+            ESP_LOGCONFIG(tag, "  Latency: timeout %u ms, %s", (unsigned) this->timeout_ms_,
+                          this->require_state_ ? "state change required" : "any frame");
+            LOG_SENSOR("  ", "Latency p50", this->p50_sensor_);
+            LOG_SENSOR("  ", "Latency p95", this->p95_sensor_);
+            LOG_SENSOR("  ", "Latency p99", this->p99_sensor_);
+            LOG_SENSOR("  ", "Latency events", this->events_sensor_);
+            LOG_SENSOR("  ", "Latency expired", this->expired_sensor_);
+        }
+
+        void LatencyTracer::input(uint8_t key, uint32_t read_us)
+        {
+            for (LatencyEvent &event : this->events_)
+            {
+                if (event.active)
+                    continue;
+                event = LatencyEvent{};
+                event.stamps_us[LATENCY_STAGE_INPUT] = read_us;
+                event.key = key;
+                event.active = true;
+                return;
+            }
+            this->overflowed_++;
+        }
+
+        void LatencyTracer::advance_(LatencyStage from, LatencyStage to)
+        {
+            uint32_t now = micros();
+            for (LatencyEvent &event : this->events_)
+            {
+                if (!event.active || event.stage != from)
+                    continue;
+                // Stages that were skipped get the same stamp, so their share is zero.
+                for (uint8_t stage = from + 1; stage <= to; stage++)
+                    event.stamps_us[stage] = now;
+                event.stage = to;
+                if (to == LATENCY_STAGE_PHOTON)
+                {
+                    this->record_(event);
+                    event.active = false;
+                }
+            }
+        }
+
+        void LatencyTracer::state_changed()
+        {
+            this->advance_(LATENCY_STAGE_INPUT, LATENCY_STAGE_STATE);
+        }
+
+        void LatencyTracer::render_started()
+        {
+            // Presses that reach RENDER here complete with this frame, not an earlier one.
+            this->advance_(LATENCY_STAGE_STATE, LATENCY_STAGE_RENDER);
+            if (!this->require_state_)
+                this->advance_(LATENCY_STAGE_INPUT, LATENCY_STAGE_RENDER);
+        }
+
+        void LatencyTracer::photon()
+        {
+            this->advance_(LATENCY_STAGE_RENDER, LATENCY_STAGE_PHOTON);
+        }
+
+#ifdef USE_LVGL
+        void LatencyTracer::on_refresh(lv_disp_t *disp)
+        {
+            if (disp->inv_p != 0)
+                this->render_started();
+        }
+
+        void LatencyTracer::on_flushed(const lv_area_t &area, bool last)
+        {
+            if (last)
+                this->photon();
+        }
+#endif
+
+        void LatencyTracer::record_(const LatencyEvent &event)
+        {
+            uint32_t total = event.stamps_us[LATENCY_STAGE_PHOTON] - event.stamps_us[LATENCY_STAGE_INPUT];
+            this->samples_us_[this->next_sample_] = total;
+            this->next_sample_ = (this->next_sample_ + 1) % LATENCY_SAMPLES;
+            if (this->sample_count_ < LATENCY_SAMPLES)
+                this->sample_count_++;
+            for (uint8_t stage = 1; stage < LATENCY_STAGE_COUNT; stage++)
+                this->stage_total_us_[stage] += event.stamps_us[stage] - event.stamps_us[stage - 1];
+            this->completed_++;
+            ESP_LOGV(TAG, "Key 0x%02X: %u us", event.key, (unsigned) total);
+        }
+
+        uint32_t LatencyTracer::percentile_us(uint8_t percentile) const
+        {
+            if (this->sample_count_ == 0)
+                return 0;
+            uint32_t sorted[LATENCY_SAMPLES];
+            std::copy(this->samples_us_, this->samples_us_ + this->sample_count_, sorted);
+            // Nearest rank: the smallest sample with at least `percentile` % at or below it.
+            uint32_t rank = (uint32_t(this->sample_count_) * percentile + 99) / 100;
+            if (rank == 0)
+                rank = 1;
+            std::nth_element(sorted, sorted + rank - 1, sorted + this->sample_count_);
+            return sorted[rank - 1];
+        }
+
+        void LatencyTracer::loop()
+        {
+            uint32_t now = millis();
+            for (LatencyEvent &event : this->events_)
+            {
+                if (event.active && (micros() - event.stamps_us[LATENCY_STAGE_INPUT]) / 1000 >= this->timeout_ms_)
+                {
+                    event.active = false;
+                    this->expired_++;
+                }
+            }
+            if (now - this->last_publish_ms_ >= this->update_interval_)
+            {
+                this->last_publish_ms_ = now;
+                this->publish_();
+            }
+        }
+
+        void LatencyTracer::publish_()
+        {
+            uint32_t p50 = this->percentile_us(50);
+            uint32_t p95 = this->percentile_us(95);
+            uint32_t p99 = this->percentile_us(99);
+            // scripts/latency_check.py parses this line.
+            ESP_LOGI(TAG, "Input latency: p50 %.1f ms, p95 %.1f ms, p99 %.1f ms (%u events, %u expired)", p50 / 1000.0f,
+                     p95 / 1000.0f, p99 / 1000.0f, (unsigned) this->completed_, (unsigned) this->expired_);
+            if (this->completed_ != 0)
+                ESP_LOGD(TAG, "Mean stages: state %.1f ms, render %.1f ms, flush %.1f ms",
+                         this->stage_total_us_[LATENCY_STAGE_STATE] / 1000.0f / this->completed_,
+                         this->stage_total_us_[LATENCY_STAGE_RENDER] / 1000.0f / this->completed_,
+                         this->stage_total_us_[LATENCY_STAGE_PHOTON] / 1000.0f / this->completed_);
+            if (this->overflowed_ != 0)
+                ESP_LOGW(TAG, "%u presses not traced, more than %u in flight", (unsigned) this->overflowed_,
+                         (unsigned) LATENCY_IN_FLIGHT);
+            if (this->sample_count_ != 0)
+            {
+                if (this->p50_sensor_ != nullptr)
+                    this->p50_sensor_->publish_state(p50 / 1000.0f);
+                if (this->p95_sensor_ != nullptr)
+                    this->p95_sensor_->publish_state(p95 / 1000.0f);
+                if (this->p99_sensor_ != nullptr)
+                    this->p99_sensor_->publish_state(p99 / 1000.0f);
+            }
+            if (this->events_sensor_ != nullptr)
+                this->events_sensor_->publish_state(this->completed_);
+            if (this->expired_sensor_ != nullptr)
+                this->expired_sensor_->publish_state(this->expired_);
+            this->sample_count_ = 0;
+            this->next_sample_ = 0;
+            for (uint32_t &total : this->stage_total_us_)
+                total = 0;
+            this->completed_ = 0;
+            this->expired_ = 0;
+            this->overflowed_ = 0;
+        }
+    } // namespace picocalc
+} // namespace esphome
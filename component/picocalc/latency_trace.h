@@ -0,0 +1,89 @@
+#pragma once
+#include "esphome/core/defines.h"
+#include <cstdint>
+#include "esphome/components/sensor/sensor.h"
+#include "display_tap.h"
+
+namespace esphome {
+namespace picocalc {
+
+static const uint8_t LATENCY_IN_FLIGHT = 8;
+static const uint8_t LATENCY_SAMPLES = 64;
+
+enum LatencyStage : uint8_t {
+    LATENCY_STAGE_INPUT = 0,   // the keyboard poll that returned the key began
+    LATENCY_STAGE_STATE,       // a label update from it was applied
+    LATENCY_STAGE_RENDER,      // LVGL started rendering the frame showing it
+    LATENCY_STAGE_PHOTON,      // the last flush of that frame returned, after its final RAMWR
+    LATENCY_STAGE_COUNT,
+};
+
+struct LatencyEvent {
+    uint32_t stamps_us[LATENCY_STAGE_COUNT]{};
+    LatencyStage stage{LATENCY_STAGE_INPUT};
+    uint8_t key{0};
+    bool active{false};
+};
+
+// Follows key presses to the screen. Each press is stamped at input, moves
+// on at the first state change after it, the first frame rendered after
+// that, and completes when that frame's last flush has been written out.
+// Presses that change nothing expire after `timeout`.
+class LatencyTracer
+#ifdef USE_LVGL
+    : public FrameListener
+#endif
+{
+    public:
+        void set_timeout(uint32_t timeout) { this->timeout_ms_ = timeout; }
+        // Without it a press is matched with the next frame whatever triggered the frame.
+        void set_require_state(bool require) { this->require_state_ = require; }
+        void set_update_interval(uint32_t interval) { this->update_interval_ = interval; }
+        void set_p50_sensor(sensor::Sensor *sensor) { this->p50_sensor_ = sensor; }
+        void set_p95_sensor(sensor::Sensor *sensor) { this->p95_sensor_ = sensor; }
+        void set_p99_sensor(sensor::Sensor *sensor) { this->p99_sensor_ = sensor; }
+        void set_events_sensor(sensor::Sensor *sensor) { this->events_sensor_ = sensor; }
+        void set_expired_sensor(sensor::Sensor *sensor) { this->expired_sensor_ = sensor; }
+
+        void input(uint8_t key, uint32_t read_us);
+        void state_changed();
+        void render_started();
+        void photon();
+
+        // Over the samples of the current interval; 0 without any.
+        uint32_t percentile_us(uint8_t percentile) const;
+        uint8_t sample_count() const { return this->sample_count_; }
+        void loop();
+        void dump_config(const char *tag);
+
+#ifdef USE_LVGL
+        void on_refresh(lv_disp_t *disp) override;
+        void on_flushed(const lv_area_t &area, bool last) override;
+#endif
+
+    protected:
+        void advance_(LatencyStage from, LatencyStage to);
+        void record_(const LatencyEvent &event);
+        void publish_();
+
+        LatencyEvent events_[LATENCY_IN_FLIGHT]{};
+        uint32_t samples_us_[LATENCY_SAMPLES]{};
+        uint8_t sample_count_{0};
+        uint8_t next_sample_{0};
+        uint32_t stage_total_us_[LATENCY_STAGE_COUNT]{};
+        uint32_t completed_{0};
+        uint32_t expired_{0};
+        uint32_t overflowed_{0};
+        uint32_t timeout_ms_{1000};
+        bool require_state_{true};
+        uint32_t update_interval_{60000};
+        uint32_t last_publish_ms_{0};
+        sensor::Sensor *p50_sensor_{nullptr};
+        sensor::Sensor *p95_sensor_{nullptr};
+        sensor::Sensor *p99_sensor_{nullptr};
+        sensor::Sensor *events_sensor_{nullptr};
+        sensor::Sensor *expired_sensor_{nullptr};
+};
+
+}  // namespace picocalc
+}  // namespace esphome
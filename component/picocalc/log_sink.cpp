@@ -0,0 +1,183 @@
+#include "log_sink.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <new>
+#include "esphome/core/hal.h"
+#include "esphome/core/log.h"
+
+#ifdef USE_LOGGER
+#include "esphome/components/logger/logger.h"
+#endif
+
+namespace esphome
+{
+    namespace picocalc
+    {
+        static const char *const TAG = "picocalc.log_sink";
+        static const char LEVEL_LETTERS[] = "-EWICDVV";
+
+        bool LogRing::init(uint16_t size)
+        {
+            this->records_ = new (std::nothrow) LogRecord[size];
+            if (this->records_ == nullptr)
+                return false;
+            this->size_ = size;
+            return true;
+        }
+
+        bool LogRing::write(uint8_t level, const char *text)
+        {
+            if (this->records_ == nullptr)
+                return false;
+            uint32_t sequence = this->write_sequence_.load(std::memory_order_relaxed);
+            do
+            {
+                if (sequence - this->read_sequence_.load(std::memory_order_acquire) >= this->size_)
+                {
+                    this->dropped_.fetch_add(1, std::memory_order_relaxed);
+                    return false;
+                }
+            } while (!this->write_sequence_.compare_exchange_weak(sequence, sequence + 1, std::memory_order_acq_rel,
+                                                                  std::memory_order_relaxed));
+            LogRecord &record = this->records_[sequence % this->size_];
+            record.level = level;
+            strncpy(record.text, text, LOG_LINE_SIZE - 1);
+            record.text[LOG_LINE_SIZE - 1] = '\0';
+            record.sequence.store(sequence + 1, std::memory_order_release);
+            return true;
+        }
+
+        bool LogRing::read(uint8_t *level, char *text)
+        {
+            if (this->records_ == nullptr)
+                return false;
+            uint32_t sequence = this->read_sequence_.load(std::memory_order_relaxed);
+            LogRecord &record = this->records_[sequence % this->size_];
+            // Claimed but not yet complete lines wait for the next read.
+            if (record.sequence.load(std::memory_order_acquire) != sequence + 1)
+                return false;
+            *level = record.level;
+            memcpy(text, record.text, LOG_LINE_SIZE);
+            this->read_sequence_.store(sequence + 1, std::memory_order_release);
+            return true;
+        }
+
+#ifdef USE_LVGL
+        bool LogSink::setup()
+        {
+            if (!this->ring_.init(this->ring_size_))
+                return false;
+#ifdef USE_LOGGER
+            if (logger::global_logger != nullptr)
+            {
+                logger::global_logger->add_on_log_callback(
+                    [this](uint8_t level, const char *tag, const char *message) { this->log(level, tag, message); });
+            }
+#endif
+            return true;
+        }
+
+        void LogSink::dump_config(const char *tag)
+        {
+            ESP_LOGCONFIG(tag, "  Log sink: %u lines, level %c, up to %u lines every %u ms", (unsigned) this->ring_size_,
+                          LEVEL_LETTERS[this->level_ & 7], (unsigned) this->max_lines_, (unsigned) this->render_interval_);
+            LOG_SENSOR("  ", "Log lines dropped", this->dropped_sensor_);
+        }
+
+        void LogSink::log(uint8_t level, const char *tag, const char *message)
+        {
+            if (level > this->level_)
+                return;
+            // The logger hands us "\033[0;36m[D][tag:123]: text\033[0m"; keep just the text.
+            const char *text = strstr(message, "]: ");
+            text = text != nullptr ? text + 3 : message;
+            char line[LOG_LINE_SIZE];
+            size_t length = snprintf(line, sizeof(line), "%c %s: ", LEVEL_LETTERS[level & 7], tag);
+            for (; *text != '\0' && length < sizeof(line) - 1; text++)
+            {
+                if (*text == '\033')
+                {
+                    while (*text != '\0' && *text != 'm')
+                        text++;
+                    if (*text == '\0')
+                        break;
+                    continue;
+                }
+                if (*text != '\n' && *text != '\r')
+                    line[length++] = *text;
+            }
+            line[std::min(length, sizeof(line) - 1)] = '\0';
+            this->ring_.write(level, line);
+        }
+
+        void LogSink::loop()
+        {
+            uint32_t now = millis();
+            if (now - this->last_publish_ms_ >= this->update_interval_)
+            {
+                this->last_publish_ms_ = now;
+                if (this->dropped_sensor_ != nullptr)
+                    this->dropped_sensor_->publish_state(this->ring_.dropped());
+            }
+            if (this->textarea_ == nullptr || now - this->last_render_ms_ < this->render_interval_)
+                return;
+            this->last_render_ms_ = now;
+            this->render_();
+        }
+
+        void LogSink::render_()
+        {
+            char batch[LOG_RENDER_MAX_LINES * (LOG_LINE_SIZE + 1) + 32];
+            char line[LOG_LINE_SIZE];
+            uint8_t level;
+            size_t length = 0;
+            uint8_t lines = 0;
+            while (lines < this->max_lines_ && this->ring_.read(&level, line))
+            {
+                length += snprintf(batch + length, sizeof(batch) - length, "\n%s", line);
+                lines++;
+            }
+            // Whatever else arrived since the last batch is over the rate.
+            uint32_t skipped = 0;
+            while (this->ring_.read(&level, line))
+                skipped++;
+            this->ring_.add_dropped(skipped);
+            uint32_t dropped = this->ring_.dropped();
+            if (dropped != this->shown_dropped_)
+            {
+                length += snprintf(batch + length, sizeof(batch) - length, "\n(%u lines dropped)",
+                                   (unsigned) (dropped - this->shown_dropped_));
+                this->shown_dropped_ = dropped;
+            }
+            if (length == 0)
+                return;
+            length = std::min(length, sizeof(batch) - 1);
+            const char *text = batch;
+            if (lv_textarea_get_text(this->textarea_)[0] == '\0')
+                text++;  // no leading newline on an empty box
+            this->trim_(length);
+            lv_textarea_set_cursor_pos(this->textarea_, LV_TEXTAREA_CURSOR_LAST);
+            lv_textarea_add_text(this->textarea_, text);
+        }
+
+        void LogSink::trim_(size_t incoming)
+        {
+            const char *current = lv_textarea_get_text(this->textarea_);
+            size_t length = strlen(current);
+            if (length + incoming <= this->max_chars_)
+                return;
+            // Keep the newest half, starting at a line boundary, moved down in
+            // place: handed back its own buffer, lv_label_set_text() only
+            // shrinks it, where the textarea could free it before reading it.
+            char *text = const_cast<char *>(current);
+            const char *tail = current + length - std::min<size_t>(length, this->max_chars_ / 2);
+            const char *newline = strchr(tail, '\n');
+            tail = newline != nullptr ? newline + 1 : current + length;
+            memmove(text, tail, strlen(tail) + 1);
+            lv_label_set_text(lv_textarea_get_label(this->textarea_), text);
+        }
+#endif
+    } // namespace picocalc
+} // namespace esphome
@@ -0,0 +1,92 @@
+#pragma once
+#include "esphome/core/defines.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#ifdef USE_LVGL
+#include <lvgl.h>
+#include "esphome/components/sensor/sensor.h"
+#endif
+
+namespace esphome {
+namespace picocalc {
+
+static const uint8_t LOG_LINE_SIZE = 64;
+static const uint8_t LOG_RENDER_MAX_LINES = 8;
+
+struct LogRecord {
+    // Sequence number + 1 of the line held here once it is complete; 0 while never written.
+    std::atomic<uint32_t> sequence{0};
+    uint8_t level{0};
+    char text[LOG_LINE_SIZE];
+};
+
+// Multi-producer, single-consumer ring of log lines. Writers claim a record
+// with a compare-and-swap and publish it with its sequence number, so
+// write() never blocks or allocates and is safe from any task on either core.
+// A full ring drops the new line and counts it.
+class LogRing {
+    public:
+        bool init(uint16_t size);
+        bool write(uint8_t level, const char *text);
+        // Copies the oldest complete line into `text` (LOG_LINE_SIZE bytes); false when there is none.
+        bool read(uint8_t *level, char *text);
+        uint16_t size() const { return this->size_; }
+        uint32_t dropped() const { return this->dropped_.load(std::memory_order_relaxed); }
+        void add_dropped(uint32_t count) { this->dropped_.fetch_add(count, std::memory_order_relaxed); }
+
+    protected:
+        LogRecord *records_{nullptr};
+        uint16_t size_{0};
+        std::atomic<uint32_t> write_sequence_{0};
+        std::atomic<uint32_t> read_sequence_{0};
+        std::atomic<uint32_t> dropped_{0};
+};
+
+#ifdef USE_LVGL
+// Shows log output in an LVGL textarea. Lines are collected in a LogRing and
+// appended in one batch per render_interval; lines beyond max_lines per
+// batch are dropped rather than delaying the next frame.
+class LogSink {
+    public:
+        void set_ring_size(uint16_t size) { this->ring_size_ = size; }
+        void set_level(uint8_t level) { this->level_ = level; }
+        void set_render_interval(uint32_t interval) { this->render_interval_ = interval; }
+        void set_max_lines(uint8_t max_lines) { this->max_lines_ = max_lines; }
+        // The textarea is cut back to half of this when it would grow beyond it.
+        void set_max_chars(uint16_t max_chars) { this->max_chars_ = max_chars; }
+        void set_update_interval(uint32_t interval) { this->update_interval_ = interval; }
+        void set_dropped_sensor(sensor::Sensor *sensor) { this->dropped_sensor_ = sensor; }
+        void set_textarea(lv_obj_t *textarea) { this->textarea_ = textarea; }
+
+        bool setup();
+        void loop();
+        void dump_config(const char *tag);
+        size_t storage_size() const { return size_t(this->ring_size_) * sizeof(LogRecord); }
+        // Called from the logger on any task; not for interrupts, as it formats
+        // with snprintf. `message` may still carry the logger's colour codes.
+        void log(uint8_t level, const char *tag, const char *message);
+
+    protected:
+        void render_();
+        void trim_(size_t incoming);
+
+        uint16_t ring_size_{32};
+        uint8_t level_{5};
+        uint32_t render_interval_{250};
+        uint8_t max_lines_{4};
+        uint16_t max_chars_{1024};
+        uint32_t update_interval_{60000};
+
+        LogRing ring_;
+        lv_obj_t *textarea_{nullptr};
+        uint32_t last_render_ms_{0};
+        uint32_t last_publish_ms_{0};
+        uint32_t shown_dropped_{0};
+        sensor::Sensor *dropped_sensor_{nullptr};
+};
+#endif
+
+}  // namespace picocalc
+}  // namespace esphome
@@ -0,0 +1,177 @@
+#include "loop_trace.h"
+
+#ifdef USE_PICOCALC_LOOP_TRACE
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include "esphome/core/log.h"
+
+namespace esphome
+{
+    namespace picocalc
+    {
+        static const uint8_t TRACE_VERSION = 1;
+        static const size_t TRACE_HEADER_SIZE = 16;
+        static const size_t TRACE_NAME_SIZE = 12;
+        static const size_t TRACE_SLOT_SIZE = TRACE_NAME_SIZE + 4 + 4 + 8 + 4 * LOOP_TRACE_BUCKETS;
+        static const size_t TRACE_CALL_SIZE = 9;
+        static const size_t TRACE_HEX_LINE = 32;
+
+        static uint8_t bucket_for(uint32_t duration_us)
+        {
+            uint8_t bucket = 0;
+            while (duration_us != 0 && bucket < LOOP_TRACE_BUCKETS - 1)
+            {
+                duration_us >>= 1;
+                bucket++;
+            }
+            return bucket;
+        }
+
+        static uint8_t *put_u32(uint8_t *out, uint32_t value)
+        {
+            for (uint8_t i = 0; i < 4; i++)
+                *out++ = value >> (8 * i);
+            return out;
+        }
+
+        uint8_t LoopTracer::register_slot(const char *name)
+        {
+            if (this->slot_count_ >= LOOP_TRACE_SLOTS)
+                return LOOP_TRACE_NO_SLOT;
+            this->slots_[this->slot_count_].name = name;
+            return this->slot_count_++;
+        }
+
+        void LoopTracer::record(uint8_t slot, uint32_t duration_us)
+        {
+            if (slot >= this->slot_count_)
+                return;
+            LoopTraceSlot &s = this->slots_[slot];
+            s.count++;
+            s.total_us += duration_us;
+            s.buckets[bucket_for(duration_us)]++;
+            if (duration_us > s.max_us)
+                s.max_us = duration_us;
+            if (duration_us >= this->slow_threshold_us_)
+                this->slow_calls_++;
+
+            // slowest_ is kept sorted, longest first.
+            if (duration_us <= this->slowest_[LOOP_TRACE_TOP_N - 1].duration_us)
+                return;
+            uint8_t pos = LOOP_TRACE_TOP_N - 1;
+            while (pos > 0 && this->slowest_[pos - 1].duration_us < duration_us)
+            {
+                this->slowest_[pos] = this->slowest_[pos - 1];
+                pos--;
+            }
+            this->slowest_[pos] = SlowCall{millis(), duration_us, slot};
+        }
+
+        uint32_t LoopTracer::percentile_us(uint8_t slot, uint8_t percentile) const
+        {
+            if (slot >= this->slot_count_ || this->slots_[slot].count == 0)
+                return 0;
+            const LoopTraceSlot &s = this->slots_[slot];
+            uint64_t target = (uint64_t(s.count) * percentile + 99) / 100;
+            uint64_t seen = 0;
+            for (uint8_t i = 0; i < LOOP_TRACE_BUCKETS - 1; i++)
+            {
+                seen += s.buckets[i];
+                if (seen >= target)
+                    return 1u << i;
+            }
+            return s.max_us;
+        }
+
+        size_t LoopTracer::serialized_size()
+        {
+            return TRACE_HEADER_SIZE + LOOP_TRACE_SLOTS * TRACE_SLOT_SIZE + LOOP_TRACE_TOP_N * TRACE_CALL_SIZE;
+        }
+
+        size_t LoopTracer::serialize(uint8_t *buffer, size_t length) const
+        {
+            size_t needed = TRACE_HEADER_SIZE + this->slot_count_ * TRACE_SLOT_SIZE + LOOP_TRACE_TOP_N * TRACE_CALL_SIZE;
+            if (length < needed)
+                return 0;
+
+            uint8_t *out = buffer;
+            memcpy(out, "PCLT", 4);
+            out += 4;
+            *out++ = TRACE_VERSION;
+            *out++ = this->slot_count_;
+            *out++ = LOOP_TRACE_BUCKETS;
+            *out++ = LOOP_TRACE_TOP_N;
+            out = put_u32(out, millis());
+            out = put_u32(out, this->slow_threshold_us_);
+
+            for (uint8_t i = 0; i < this->slot_count_; i++)
+            {
+                const LoopTraceSlot &s = this->slots_[i];
+                memset(out, 0, TRACE_NAME_SIZE);
+                strncpy(reinterpret_cast<char *>(out), s.name, TRACE_NAME_SIZE);
+                out += TRACE_NAME_SIZE;
+                out = put_u32(out, s.count);
+                out = put_u32(out, s.max_us);
+                out = put_u32(out, s.total_us);
+                out = put_u32(out, s.total_us >> 32);
+                for (uint32_t bucket : s.buckets)
+                    out = put_u32(out, bucket);
+            }
+
+            for (const SlowCall &call : this->slowest_)
+            {
+                out = put_u32(out, call.timestamp_ms);
+                out = put_u32(out, call.duration_us);
+                *out++ = call.slot;
+            }
+            return out - buffer;
+        }
+
+        void LoopTracer::dump(const char *tag) const
+        {
+            for (uint8_t i = 0; i < this->slot_count_; i++)
+            {
+                const LoopTraceSlot &s = this->slots_[i];
+                ESP_LOGD(tag, "Loop %s: %u calls, avg %u us, p50 <%u us, p99 <%u us, max %u us", s.name,
+                         (unsigned) s.count, (unsigned) (s.count ? s.total_us / s.count : 0),
+                         (unsigned) this->percentile_us(i, 50), (unsigned) this->percentile_us(i, 99),
+                         (unsigned) s.max_us);
+            }
+            for (const SlowCall &call : this->slowest_)
+            {
+                if (call.slot == LOOP_TRACE_NO_SLOT)
+                    break;
+                ESP_LOGD(tag, "  slow %s: %u us at %u ms", this->slots_[call.slot].name,
+                         (unsigned) call.duration_us, (unsigned) call.timestamp_ms);
+            }
+
+            uint8_t buffer[TRACE_HEADER_SIZE + LOOP_TRACE_SLOTS * TRACE_SLOT_SIZE + LOOP_TRACE_TOP_N * TRACE_CALL_SIZE];
+            size_t length = this->serialize(buffer, sizeof(buffer));
+            char hex[TRACE_HEX_LINE * 2 + 1];
+            for (size_t offset = 0; offset < length; offset += TRACE_HEX_LINE)
+            {
+                size_t chunk = std::min(TRACE_HEX_LINE, length - offset);
+                for (size_t i = 0; i < chunk; i++)
+                    snprintf(hex + 2 * i, 3, "%02x", buffer[offset + i]);
+                ESP_LOGD(tag, "trace:%04x:%s", (unsigned) offset, hex);
+            }
+        }
+
+        void LoopTracer::reset()
+        {
+            for (uint8_t i = 0; i < this->slot_count_; i++)
+            {
+                const char *name = this->slots_[i].name;
+                this->slots_[i] = LoopTraceSlot{};
+                this->slots_[i].name = name;
+            }
+            for (SlowCall &call : this->slowest_)
+                call = SlowCall{};
+            this->slow_calls_ = 0;
+        }
+    } // namespace picocalc
+} // namespace esphome
+
+#endif  // USE_PICOCALC_LOOP_TRACE
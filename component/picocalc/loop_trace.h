@@ -0,0 +1,116 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include "esphome/core/defines.h"
+#include "esphome/core/component.h"
+#include "esphome/core/hal.h"
+
+namespace esphome {
+namespace picocalc {
+
+// Bucket 0 holds calls under 1 us, bucket i holds [2^(i-1), 2^i) us and the
+// last bucket collects everything from 2^18 us (~262 ms) up.
+static const uint8_t LOOP_TRACE_BUCKETS = 20;
+static const uint8_t LOOP_TRACE_SLOTS = 4;
+static const uint8_t LOOP_TRACE_TOP_N = 8;
+static const uint8_t LOOP_TRACE_NO_SLOT = 0xFF;
+
+struct LoopTraceSlot {
+    const char *name{nullptr};
+    uint32_t count{0};
+    uint32_t max_us{0};
+    uint64_t total_us{0};
+    uint32_t buckets[LOOP_TRACE_BUCKETS]{};
+};
+
+struct SlowCall {
+    uint32_t timestamp_ms{0};
+    uint32_t duration_us{0};
+    uint8_t slot{LOOP_TRACE_NO_SLOT};
+};
+
+class LoopTracer {
+    public:
+        uint8_t register_slot(const char *name);
+        void record(uint8_t slot, uint32_t duration_us);
+
+        const LoopTraceSlot &slot(uint8_t slot) const { return this->slots_[slot]; }
+        uint8_t slot_count() const { return this->slot_count_; }
+        // Upper bound of the bucket holding the requested percentile (0-100).
+        uint32_t percentile_us(uint8_t slot, uint8_t percentile) const;
+        const SlowCall *slowest() const { return this->slowest_; }
+
+        void set_slow_threshold(uint32_t threshold_us) { this->slow_threshold_us_ = threshold_us; }
+        uint32_t slow_threshold() const { return this->slow_threshold_us_; }
+        uint32_t slow_calls() const { return this->slow_calls_; }
+
+        // Packs histograms and the slowest calls into the little-endian format
+        // decoded by scripts/loop_trace.py. Returns the number of bytes written.
+        size_t serialize(uint8_t *buffer, size_t length) const;
+        static size_t serialized_size();
+        // Logs the serialized trace as hex lines prefixed with "trace:".
+        void dump(const char *tag) const;
+        void reset();
+
+    protected:
+        LoopTraceSlot slots_[LOOP_TRACE_SLOTS]{};
+        SlowCall slowest_[LOOP_TRACE_TOP_N]{};
+        uint8_t slot_count_{0};
+        uint32_t slow_threshold_us_{30000};
+        uint32_t slow_calls_{0};
+};
+
+// Times the enclosing block into one tracer slot. Does nothing unless
+// loop_trace is configured, as LoopTracer is only compiled in then.
+class LoopTraceScope {
+    public:
+        LoopTraceScope(LoopTracer *tracer, uint8_t slot) : tracer_(tracer), slot_(slot), start_(micros()) {}
+        ~LoopTraceScope()
+        {
+#ifdef USE_PICOCALC_LOOP_TRACE
+            if (this->tracer_ != nullptr)
+                this->tracer_->record(this->slot_, micros() - this->start_);
+#endif
+        }
+
+    protected:
+        LoopTracer *tracer_;
+        uint8_t slot_;
+        uint32_t start_;
+};
+
+// Brackets one pass over the component loops. ESPHome calls loop() in setup
+// priority order, so the marker without `first` runs before every other
+// component and the one with it runs after them all; the latter records the
+// time in between, which leaves out the scheduler and the loop_interval sleep.
+class LoopPassMarker : public Component {
+    public:
+        explicit LoopPassMarker(LoopPassMarker *first = nullptr) : first_(first) {}
+        void set_tracer(LoopTracer *tracer, uint8_t slot)
+        {
+            this->tracer_ = tracer;
+            this->slot_ = slot;
+        }
+
+        void loop() override
+        {
+            uint32_t now = micros();
+            if (this->first_ == nullptr)
+                this->started_us_ = now;
+#ifdef USE_PICOCALC_LOOP_TRACE
+            else if (this->tracer_ != nullptr && this->first_->started_us_ != 0)
+                this->tracer_->record(this->slot_, now - this->first_->started_us_);
+#endif
+        }
+        float get_setup_priority() const override { return this->first_ == nullptr ? 100000.0f : -100000.0f; }
+        float get_loop_priority() const override { return this->get_setup_priority(); }
+
+    protected:
+        LoopPassMarker *first_;
+        LoopTracer *tracer_{nullptr};
+        uint8_t slot_{LOOP_TRACE_NO_SLOT};
+        uint32_t started_us_{0};
+};
+
+}  // namespace picocalc
+}  // namespace esphome
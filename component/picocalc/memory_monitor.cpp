@@ -0,0 +1,133 @@
+#include "memory_monitor.h"
+#include <cstring>
+#include "esphome/core/log.h"
+
+#ifdef USE_RP2040
+#include <Arduino.h>
+#include <malloc.h>
+#endif
+#ifdef USE_PICOCALC_FREERTOS
+#include <FreeRTOS.h>
+#include <task.h>
+#endif
+
+namespace esphome
+{
+    namespace picocalc
+    {
+#ifdef USE_PICOCALC_FREERTOS
+        static const uint8_t MAX_TRACKED_TASKS = 16;
+#endif
+
+        uint8_t MemoryMonitor::register_budget(const char *name, uint32_t limit)
+        {
+            if (this->budget_count_ >= MEMORY_BUDGET_SLOTS)
+                return MEMORY_NO_BUDGET;
+            this->budgets_[this->budget_count_].name = name;
+            this->budgets_[this->budget_count_].limit = limit;
+            return this->budget_count_++;
+        }
+
+        void MemoryMonitor::set_used(uint8_t handle, uint32_t used)
+        {
+            if (handle >= this->budget_count_)
+                return;
+            MemoryBudget &budget = this->budgets_[handle];
+            budget.used = used;
+            if (used > budget.peak)
+                budget.peak = used;
+        }
+
+        void MemoryMonitor::add_used(uint8_t handle, int32_t delta)
+        {
+            if (handle >= this->budget_count_)
+                return;
+            int64_t used = int64_t(this->budgets_[handle].used) + delta;
+            this->set_used(handle, used < 0 ? 0 : uint32_t(used));
+        }
+
+        uint8_t MemoryMonitor::find(const char *name) const
+        {
+            for (uint8_t i = 0; i < this->budget_count_; i++)
+            {
+                if (strcmp(this->budgets_[i].name, name) == 0)
+                    return i;
+            }
+            return MEMORY_NO_BUDGET;
+        }
+
+        uint32_t MemoryMonitor::total_used() const
+        {
+            uint32_t total = 0;
+            for (uint8_t i = 0; i < this->budget_count_; i++)
+                total += this->budgets_[i].used;
+            return total;
+        }
+
+        HeapInfo MemoryMonitor::heap_info()
+        {
+            HeapInfo info;
+#ifdef USE_RP2040
+            struct mallinfo mi = mallinfo();
+            info.total = rp2040.getTotalHeap();
+            info.free = rp2040.getFreeHeap();
+            uint32_t untouched = info.total > uint32_t(mi.arena) ? info.total - mi.arena : 0;
+            info.largest_free_block = untouched + mi.keepcost;
+#endif
+            if (info.total != 0 && info.free < this->min_free_heap_)
+                this->min_free_heap_ = info.free;
+            return info;
+        }
+
+        uint32_t MemoryMonitor::scan_stacks_(const char *tag) const
+        {
+#ifdef USE_PICOCALC_FREERTOS
+#if configUSE_TRACE_FACILITY
+            TaskStatus_t tasks[MAX_TRACKED_TASKS];
+            UBaseType_t count = uxTaskGetSystemState(tasks, MAX_TRACKED_TASKS, nullptr);
+            uint32_t lowest = UINT32_MAX;
+            for (UBaseType_t i = 0; i < count; i++)
+            {
+                uint32_t free_bytes = tasks[i].usStackHighWaterMark * sizeof(StackType_t);
+                if (tag != nullptr)
+                    ESP_LOGD(tag, "  task %-12s stack free %u B", tasks[i].pcTaskName, (unsigned) free_bytes);
+                if (free_bytes < lowest)
+                    lowest = free_bytes;
+            }
+            return count == 0 ? 0 : lowest;
+#else
+            // Without the trace facility only the calling (main loop) task can be inspected.
+            uint32_t free_bytes = uxTaskGetStackHighWaterMark(nullptr) * sizeof(StackType_t);
+            if (tag != nullptr)
+                ESP_LOGD(tag, "  loop task stack free %u B", (unsigned) free_bytes);
+            return free_bytes;
+#endif
+#else
+            return 0;
+#endif
+        }
+
+        void MemoryMonitor::log_report(const char *tag)
+        {
+            HeapInfo heap = this->heap_info();
+            ESP_LOGD(tag, "Heap: %u/%u B free, largest block >= %u B, min free %u B", (unsigned) heap.free,
+                     (unsigned) heap.total, (unsigned) heap.largest_free_block,
+                     (unsigned) (this->min_free_heap_ == UINT32_MAX ? 0 : this->min_free_heap_));
+            this->scan_stacks_(tag);
+            for (uint8_t i = 0; i < this->budget_count_; i++)
+            {
+                const MemoryBudget &budget = this->budgets_[i];
+                if (budget.limit != 0 && budget.used > budget.limit)
+                {
+                    ESP_LOGW(tag, "  %-16s %6u B used, over its %u B budget (peak %u B)", budget.name,
+                             (unsigned) budget.used, (unsigned) budget.limit, (unsigned) budget.peak);
+                }
+                else
+                {
+                    ESP_LOGD(tag, "  %-16s %6u B used of %u B (peak %u B)", budget.name, (unsigned) budget.used,
+                             (unsigned) budget.limit, (unsigned) budget.peak);
+                }
+            }
+        }
+    } // namespace picocalc
+} // namespace esphome
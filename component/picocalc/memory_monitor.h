@@ -0,0 +1,55 @@
+#pragma once
+#include <cstdint>
+#include "esphome/core/defines.h"
+
+namespace esphome {
+namespace picocalc {
+
+static const uint8_t MEMORY_BUDGET_SLOTS = 12;
+static const uint8_t MEMORY_NO_BUDGET = 0xFF;
+
+// What one display subsystem expects to hold (limit) and currently holds (used).
+struct MemoryBudget {
+    const char *name{nullptr};
+    uint32_t limit{0};
+    uint32_t used{0};
+    uint32_t peak{0};
+};
+
+struct HeapInfo {
+    uint32_t total{0};
+    uint32_t free{0};
+    // Lower bound: the untouched space above the allocator's arena plus its
+    // free top chunk. Holes further down are not walked.
+    uint32_t largest_free_block{0};
+};
+
+class MemoryMonitor {
+    public:
+        uint8_t register_budget(const char *name, uint32_t limit);
+        void set_used(uint8_t handle, uint32_t used);
+        void add_used(uint8_t handle, int32_t delta);
+        // MEMORY_NO_BUDGET when no budget has that name.
+        uint8_t find(const char *name) const;
+
+        uint8_t budget_count() const { return this->budget_count_; }
+        const MemoryBudget &budget(uint8_t handle) const { return this->budgets_[handle]; }
+        uint32_t total_used() const;
+
+        HeapInfo heap_info();
+        uint32_t min_free_heap() const { return this->min_free_heap_; }
+        // Smallest remaining stack over all FreeRTOS tasks, in bytes; 0 when unknown.
+        uint32_t stack_high_water() const { return this->scan_stacks_(nullptr); }
+
+        void log_report(const char *tag);
+
+    protected:
+        uint32_t scan_stacks_(const char *tag) const;
+
+        MemoryBudget budgets_[MEMORY_BUDGET_SLOTS]{};
+        uint8_t budget_count_{0};
+        uint32_t min_free_heap_{UINT32_MAX};
+};
+
+}  // namespace picocalc
+}  // namespace esphome
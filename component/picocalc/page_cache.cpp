@@ -0,0 +1,314 @@
+#include "page_cache.h"
+
+#ifdef USE_LVGL
+
+#include <cstring>
+#include <new>
+#include "esphome/core/hal.h"
+#include "esphome/core/log.h"
+
+namespace esphome
+{
+    namespace picocalc
+    {
+        static const char *const TAG = "picocalc.page_cache";
+
+        static void hash_bytes(uint32_t &hash, const void *data, size_t length)
+        {
+            const uint8_t *bytes = static_cast<const uint8_t *>(data);
+            for (size_t i = 0; i < length; i++)
+                hash = (hash ^ bytes[i]) * 16777619u;
+        }
+
+        bool PageCache::setup(DisplayTap *tap, const UpdateQueue *queue)
+        {
+            this->tap_ = tap;
+            this->queue_ = queue;
+            for (uint8_t i = 0; i < this->pages_; i++)
+            {
+                this->snapshots_[i].data = new (std::nothrow) uint8_t[this->page_size_];
+                if (this->snapshots_[i].data == nullptr)
+                {
+                    ESP_LOGW(TAG, "No memory for page %u of %u", (unsigned) (i + 1), (unsigned) this->pages_);
+                    this->pages_ = i;
+                    break;
+                }
+            }
+            tap->add_listener(this);
+            tap->request_shadow(this->tile_slot_size_);
+            return this->pages_ != 0;
+        }
+
+        void PageCache::dump_config(const char *tag)
+        {
+            ESP_LOGCONFIG(tag, "  Page cache: %u pages of %u B, tile slots of %u B, max age %u s%s", (unsigned) this->pages_,
+                          (unsigned) this->page_size_, (unsigned) this->tile_slot_size_, (unsigned) (this->max_age_ / 1000),
+                          this->enabled_ ? "" : " (disabled)");
+            LOG_SENSOR("  ", "Cached switch time", this->cached_switch_time_sensor_);
+            LOG_SENSOR("  ", "Uncached switch time", this->uncached_switch_time_sensor_);
+            LOG_SENSOR("  ", "Page cache hits", this->hits_sensor_);
+            LOG_SENSOR("  ", "Page cache misses", this->misses_sensor_);
+        }
+
+        void PageCache::set_enabled(bool enabled)
+        {
+            this->enabled_ = enabled;
+            if (!enabled)
+                this->clear();
+        }
+
+        void PageCache::clear()
+        {
+            for (uint8_t i = 0; i < this->pages_; i++)
+                this->snapshots_[i].screen = nullptr;
+            this->pending_ = nullptr;
+        }
+
+        void PageCache::loop()
+        {
+            lv_disp_t *disp = this->tap_->get_disp();
+            if (disp == nullptr)
+                return;
+            // Pages are screens; hook the ones created since the last pass.
+            for (; this->hooked_screens_ < disp->screen_cnt; this->hooked_screens_++)
+            {
+                lv_obj_t *screen = disp->screens[this->hooked_screens_];
+                lv_obj_add_event_cb(screen, screen_unload_, LV_EVENT_SCREEN_UNLOAD_START, this);
+                lv_obj_add_event_cb(screen, screen_loaded_, LV_EVENT_SCREEN_LOADED, this);
+            }
+        }
+
+        PageSnapshot *PageCache::find_(lv_obj_t *screen)
+        {
+            for (uint8_t i = 0; i < this->pages_; i++)
+            {
+                if (this->snapshots_[i].screen == screen)
+                    return &this->snapshots_[i];
+            }
+            return nullptr;
+        }
+
+        PageSnapshot *PageCache::slot_for_(lv_obj_t *screen)
+        {
+            PageSnapshot *slot = this->find_(screen);
+            if (slot != nullptr)
+                return slot;
+            // Otherwise an empty slot, or the least recently used one.
+            for (uint8_t i = 0; i < this->pages_; i++)
+            {
+                PageSnapshot *candidate = &this->snapshots_[i];
+                if (candidate->screen == nullptr)
+                    return candidate;
+                if (slot == nullptr || millis() - candidate->used_ms > millis() - slot->used_ms)
+                    slot = candidate;
+            }
+            return slot;
+        }
+
+        void PageCache::screen_unload_(lv_event_t *event)
+        {
+            auto *cache = static_cast<PageCache *>(lv_event_get_user_data(event));
+            cache->timing_ = true;
+            cache->timing_hit_ = false;
+            cache->switch_start_us_ = micros();
+            if (cache->enabled_)
+                cache->snapshot_(lv_event_get_target(event));
+        }
+
+        void PageCache::screen_loaded_(lv_event_t *event)
+        {
+            auto *cache = static_cast<PageCache *>(lv_event_get_user_data(event));
+            if (!cache->enabled_)
+                return;
+            PageSnapshot *snapshot = cache->find_(lv_event_get_target(event));
+            // A widget changed on a hidden page invalidates nothing, so compare the page with how it was left.
+            if (snapshot != nullptr &&
+                (millis() - snapshot->taken_ms > cache->max_age_ || cache->fingerprint_(snapshot->screen) != snapshot->fingerprint))
+            {
+                snapshot->screen = nullptr;
+                snapshot = nullptr;
+            }
+            if (snapshot == nullptr)
+            {
+                cache->misses_++;
+                return;
+            }
+            // LVGL invalidates the whole screen right after this event, so the
+            // restore waits for the refresh timer.
+            cache->hits_++;
+            cache->timing_hit_ = true;
+            snapshot->used_ms = millis();
+            cache->pending_ = snapshot;
+        }
+
+        void PageCache::snapshot_(lv_obj_t *screen)
+        {
+            ScreenShadow *shadow = this->tap_->get_shadow();
+            PageSnapshot *snapshot = this->slot_for_(screen);
+            if (shadow == nullptr || snapshot == nullptr)
+                return;
+            uint16_t tiles = shadow->tile_count();
+            uint32_t offset = uint32_t(tiles) * 2;
+            if (offset > this->page_size_)
+                return;
+            uint8_t *data = snapshot->data;
+            for (uint16_t tile = 0; tile < tiles; tile++)
+            {
+                uint16_t length = shadow->is_exact(tile) ? shadow->tile_length(tile) : 0;
+                if (offset + length > this->page_size_)
+                    length = 0;
+                data[tile * 2] = length & 0xFF;
+                data[tile * 2 + 1] = length >> 8;
+                memcpy(data + offset, shadow->tile_data(tile), length);
+                offset += length;
+            }
+            snapshot->screen = screen;
+            snapshot->length = offset;
+            // The tiles hold what was last flushed; labels applied after that are not in them.
+            snapshot->epoch = this->flushed_epoch_;
+            snapshot->fingerprint = this->fingerprint_(screen);
+            snapshot->taken_ms = snapshot->used_ms = millis();
+        }
+
+        void PageCache::on_refresh(lv_disp_t *disp)
+        {
+            if (this->pending_ == nullptr)
+                return;
+            PageSnapshot *snapshot = this->pending_;
+            this->pending_ = nullptr;
+            // A snapshot evicted in between no longer belongs to the active screen.
+            if (snapshot->screen == lv_scr_act())
+                this->restore_(disp, snapshot);
+        }
+
+        void PageCache::restore_(lv_disp_t *disp, PageSnapshot *snapshot)
+        {
+            ScreenShadow *shadow = this->tap_->get_shadow();
+            uint16_t tiles = shadow->tile_count();
+            const uint8_t *data = snapshot->data;
+            uint32_t offset = uint32_t(tiles) * 2;
+            uint16_t blitted = 0;
+
+            // Throw away the full-screen invalidation of the page switch and
+            // put back only what the snapshot cannot provide. Anything else
+            // invalidated since the load is still pending and is kept.
+            lv_area_t screen_area;
+            lv_area_set(&screen_area, 0, 0, lv_disp_get_hor_res(disp) - 1, lv_disp_get_ver_res(disp) - 1);
+            lv_area_t kept[LV_INV_BUF_SIZE];
+            uint16_t kept_count = 0;
+            for (uint16_t i = 0; i < disp->inv_p; i++)
+            {
+                if (!disp->inv_area_joined[i] && !_lv_area_is_in(&screen_area, &disp->inv_areas[i], 0))
+                    kept[kept_count++] = disp->inv_areas[i];
+            }
+            disp->inv_p = 0;
+            for (uint16_t tile = 0; tile < tiles; tile++)
+            {
+                uint16_t length = data[tile * 2] | (data[tile * 2 + 1] << 8);
+                lv_area_t area = shadow->tile_area(tile);
+                const uint16_t *pixels = nullptr;
+                if (length != 0 && shadow->store(tile, data + offset, length))
+                    pixels = shadow->expand(tile);
+                offset += length;
+                if (pixels == nullptr)
+                {
+                    shadow->forget(tile);
+                    _lv_inv_area(disp, &area);
+                    continue;
+                }
+                this->tap_->blit(area, pixels);
+                blitted++;
+            }
+            for (uint16_t i = 0; i < kept_count; i++)
+                _lv_inv_area(disp, &kept[i]);
+            if (this->queue_ != nullptr)
+                this->queue_->invalidate_since(snapshot->epoch);
+            lv_obj_t *top = lv_layer_top();
+            for (uint32_t i = 0; i < lv_obj_get_child_cnt(top); i++)
+                lv_obj_invalidate(lv_obj_get_child(top, i));
+            ESP_LOGV(TAG, "Restored %u/%u tiles, %u areas left to render", (unsigned) blitted, (unsigned) tiles,
+                     (unsigned) disp->inv_p);
+            // Nothing left for LVGL to flush, so the switch is complete already.
+            if (disp->inv_p == 0)
+                this->finish_switch_();
+        }
+
+        uint32_t PageCache::fingerprint_(lv_obj_t *screen) const
+        {
+            // FNV-1a over what a hidden page can change without anyone noticing.
+            uint32_t hash = 2166136261u;
+            this->hash_tree_(screen, hash);
+            return hash;
+        }
+
+        void PageCache::hash_tree_(lv_obj_t *obj, uint32_t &hash) const
+        {
+            // Labels fed by the update queue are redrawn from its epoch instead.
+            bool queued = lv_obj_check_type(obj, &lv_label_class) && this->queue_ != nullptr && this->queue_->tracks(obj);
+            if (!queued)
+            {
+                lv_area_t coords;
+                lv_obj_get_coords(obj, &coords);
+                hash_bytes(hash, &coords, sizeof(coords));
+                lv_state_t state = lv_obj_get_state(obj);
+                hash_bytes(hash, &state, sizeof(state));
+                bool hidden = lv_obj_has_flag(obj, LV_OBJ_FLAG_HIDDEN);
+                hash_bytes(hash, &hidden, sizeof(hidden));
+                if (lv_obj_check_type(obj, &lv_label_class))
+                {
+                    const char *text = lv_label_get_text(obj);
+                    hash_bytes(hash, text, strlen(text));
+                }
+#if LV_USE_BAR
+                if (lv_obj_check_type(obj, &lv_bar_class))
+                {
+                    int32_t value = lv_bar_get_value(obj);
+                    hash_bytes(hash, &value, sizeof(value));
+                }
+#endif
+#if LV_USE_SLIDER
+                if (lv_obj_check_type(obj, &lv_slider_class))
+                {
+                    int32_t value = lv_slider_get_value(obj);
+                    hash_bytes(hash, &value, sizeof(value));
+                }
+#endif
+#if LV_USE_ARC
+                if (lv_obj_check_type(obj, &lv_arc_class))
+                {
+                    int32_t value = lv_arc_get_value(obj);
+                    hash_bytes(hash, &value, sizeof(value));
+                }
+#endif
+            }
+            uint32_t children = lv_obj_get_child_cnt(obj);
+            hash_bytes(hash, &children, sizeof(children));
+            for (uint32_t i = 0; i < children; i++)
+                this->hash_tree_(lv_obj_get_child(obj, i), hash);
+        }
+
+        void PageCache::on_flush(const lv_area_t &area, const lv_color_t *pixels, bool last)
+        {
+            if (last && this->queue_ != nullptr)
+                this->flushed_epoch_ = this->queue_->epoch();
+            if (last && this->timing_ && this->pending_ == nullptr)
+                this->finish_switch_();
+        }
+
+        void PageCache::finish_switch_()
+        {
+            this->timing_ = false;
+            uint32_t elapsed_us = micros() - this->switch_start_us_;
+            ESP_LOGD(TAG, "Page switch took %.1f ms (%s)", elapsed_us / 1000.0f, this->timing_hit_ ? "cached" : "uncached");
+            sensor::Sensor *target = this->timing_hit_ ? this->cached_switch_time_sensor_ : this->uncached_switch_time_sensor_;
+            if (target != nullptr)
+                target->publish_state(elapsed_us / 1000.0f);
+            if (this->hits_sensor_ != nullptr)
+                this->hits_sensor_->publish_state(this->hits_);
+            if (this->misses_sensor_ != nullptr)
+                this->misses_sensor_->publish_state(this->misses_);
+        }
+    } // namespace picocalc
+} // namespace esphome
+
+#endif  // USE_LVGL
@@ -0,0 +1,98 @@
+#pragma once
+#include "esphome/core/defines.h"
+
+#ifdef USE_LVGL
+#include <cstdint>
+#include <lvgl.h>
+#include "esphome/components/sensor/sensor.h"
+#include "display_tap.h"
+#include "update_queue.h"
+
+namespace esphome {
+namespace picocalc {
+
+static const uint8_t PAGE_CACHE_MAX_PAGES = 8;
+
+// A page as it was last on screen: one little-endian length per shadow tile
+// (0 when the tile was not exact or did not fit) followed by the tile data.
+struct PageSnapshot {
+    lv_obj_t *screen{nullptr};
+    uint8_t *data{nullptr};
+    uint32_t length{0};
+    uint32_t epoch{0};
+    // Widget state outside the update queue; see PageCache::fingerprint_().
+    uint32_t fingerprint{0};
+    uint32_t taken_ms{0};
+    uint32_t used_ms{0};
+};
+
+// Keeps compressed snapshots of the most recently left pages. When one of
+// them is shown again the snapshot is blitted before LVGL renders, and only
+// tiles missing from it, labels changed since it was taken and the top layer
+// (header and footer) are redrawn. A page whose other widgets changed while
+// it was hidden is rendered in full.
+class PageCache : public FrameListener {
+    public:
+        void set_pages(uint8_t pages) { this->pages_ = pages; }
+        void set_page_size(uint32_t page_size) { this->page_size_ = page_size; }
+        // Compressed tiles larger than this are never cached.
+        void set_tile_slot_size(uint16_t slot_size) { this->tile_slot_size_ = slot_size; }
+        // Snapshots older than this are not trusted, covering changes the fingerprint cannot see (styles, images).
+        void set_max_age(uint32_t max_age) { this->max_age_ = max_age; }
+        // Switching the cache off at runtime allows comparing switch times with and without it.
+        void set_enabled(bool enabled);
+        bool is_enabled() const { return this->enabled_; }
+        void clear();
+        void set_cached_switch_time_sensor(sensor::Sensor *sensor) { this->cached_switch_time_sensor_ = sensor; }
+        void set_uncached_switch_time_sensor(sensor::Sensor *sensor) { this->uncached_switch_time_sensor_ = sensor; }
+        void set_hits_sensor(sensor::Sensor *sensor) { this->hits_sensor_ = sensor; }
+        void set_misses_sensor(sensor::Sensor *sensor) { this->misses_sensor_ = sensor; }
+
+        bool setup(DisplayTap *tap, const UpdateQueue *queue);
+        void loop();
+        void dump_config(const char *tag);
+        size_t storage_size() const { return size_t(this->pages_) * this->page_size_; }
+
+        void on_refresh(lv_disp_t *disp) override;
+        void on_flush(const lv_area_t &area, const lv_color_t *pixels, bool last) override;
+
+    protected:
+        static void screen_unload_(lv_event_t *event);
+        static void screen_loaded_(lv_event_t *event);
+        void snapshot_(lv_obj_t *screen);
+        void restore_(lv_disp_t *disp, PageSnapshot *snapshot);
+        uint32_t fingerprint_(lv_obj_t *screen) const;
+        void hash_tree_(lv_obj_t *obj, uint32_t &hash) const;
+        PageSnapshot *find_(lv_obj_t *screen);
+        PageSnapshot *slot_for_(lv_obj_t *screen);
+        void finish_switch_();
+
+        DisplayTap *tap_{nullptr};
+        const UpdateQueue *queue_{nullptr};
+        uint8_t pages_{2};
+        uint32_t page_size_{16384};
+        uint16_t tile_slot_size_{384};
+        uint32_t max_age_{600000};
+        bool enabled_{true};
+
+        PageSnapshot snapshots_[PAGE_CACHE_MAX_PAGES];
+        uint32_t hooked_screens_{0};
+        PageSnapshot *pending_{nullptr};
+        // Update queue epoch as of the last completed frame.
+        uint32_t flushed_epoch_{0};
+        bool timing_{false};
+        bool timing_hit_{false};
+        uint32_t switch_start_us_{0};
+        uint32_t hits_{0};
+        uint32_t misses_{0};
+
+        sensor::Sensor *cached_switch_time_sensor_{nullptr};
+        sensor::Sensor *uncached_switch_time_sensor_{nullptr};
+        sensor::Sensor *hits_sensor_{nullptr};
+        sensor::Sensor *misses_sensor_{nullptr};
+};
+
+}  // namespace picocalc
+}  // namespace esphome
+
+#endif  // USE_LVGL
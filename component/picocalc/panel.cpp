@@ -0,0 +1,114 @@
+#include "panel.h"
+#include <cmath>
+#include "esphome/core/hal.h"
+
+namespace esphome
+{
+    namespace picocalc
+    {
+        void Panel::send_(uint8_t command, const uint8_t *data, uint8_t length)
+        {
+            uint32_t start = micros();
+            this->send_command(command, data, length);
+            this->time_spent_us_ += micros() - start;
+            this->bytes_sent_ += 1 + length;
+        }
+
+        void Panel::scroll_to(uint16_t line)
+        {
+            uint8_t data[2] = {uint8_t(line >> 8), uint8_t(line & 0xFF)};
+            this->send_(PANEL_VSCRSADD, data, sizeof(data));
+        }
+
+        void Panel::set_scroll_margins(uint16_t top, uint16_t bottom)
+        {
+            if (top + bottom > this->height_)
+                return;
+            uint16_t middle = this->height_ - (top + bottom);
+            uint8_t data[6] = {
+                uint8_t(top >> 8), uint8_t(top & 0xFF),
+                uint8_t(middle >> 8), uint8_t(middle & 0xFF),
+                uint8_t(bottom >> 8), uint8_t(bottom & 0xFF),
+            };
+            this->send_(PANEL_VSCRDEF, data, sizeof(data));
+        }
+
+        void Panel::set_inverted(bool inverted)
+        {
+            this->send_(inverted ? PANEL_INVON : PANEL_INVOFF, nullptr, 0);
+            this->inverted_ = inverted;
+        }
+
+        void Panel::set_madctl(uint8_t madctl)
+        {
+            this->send_(PANEL_MADCTL, &madctl, 1);
+            this->madctl_ = madctl;
+        }
+
+        void Panel::send_frame_rate_(uint8_t command, float hz)
+        {
+            // rate = 615 kHz / (clocks per line * 2^DIVA * (320 lines + 4 porch lines)),
+            // with 16..31 clocks per line. Pick the closest combination.
+            uint8_t data[2] = {0x00, 0x1F};
+            float best = INFINITY;
+            for (uint8_t division = 0; division < 4; division++)
+            {
+                for (uint8_t clocks = 16; clocks < 32; clocks++)
+                {
+                    float error = fabsf(615000.0f / (clocks * (1 << division) * 324.0f) - hz);
+                    if (error < best)
+                    {
+                        best = error;
+                        data[0] = division;
+                        data[1] = clocks;
+                    }
+                }
+            }
+            this->send_(command, data, sizeof(data));
+        }
+
+        void Panel::set_frame_rate(float hz)
+        {
+            this->send_frame_rate_(PANEL_FRMCTR1, hz);
+        }
+
+        void Panel::restore_frame_rate()
+        {
+            this->send_(PANEL_FRMCTR1, this->frame_control_, sizeof(this->frame_control_));
+        }
+
+        void Panel::set_idle_frame_rate(float hz)
+        {
+            this->send_frame_rate_(PANEL_FRMCTR2, hz);
+        }
+
+        void Panel::set_idle_mode(bool idle)
+        {
+            this->send_(idle ? PANEL_IDMON : PANEL_IDMOFF, nullptr, 0);
+            this->idle_mode_ = idle;
+        }
+
+        bool Panel::set_sleep(bool sleep)
+        {
+            if (sleep == this->sleeping_)
+                return true;
+            uint32_t now = millis();
+            if (sleep && this->sleep_out_ms_ != 0 && now - this->sleep_out_ms_ < PANEL_SLPOUT_TO_SLPIN_MS)
+                return false;
+            this->send_(sleep ? PANEL_SLPIN : PANEL_SLPOUT, nullptr, 0);
+            if (!sleep)
+                this->sleep_out_ms_ = now == 0 ? 1 : now;
+            this->sleeping_ = sleep;
+            return true;
+        }
+
+        void Panel::wait_awake()
+        {
+            if (this->sleep_out_ms_ == 0)
+                return;
+            uint32_t elapsed = millis() - this->sleep_out_ms_;
+            if (elapsed < PANEL_SLPOUT_SETTLE_MS)
+                delay(PANEL_SLPOUT_SETTLE_MS - elapsed);
+        }
+    } // namespace picocalc
+} // namespace esphome
@@ -0,0 +1,99 @@
+#pragma once
+#include <cstdint>
+#include "esphome/core/defines.h"
+
+namespace esphome {
+
+class PollingComponent;
+
+namespace picocalc {
+
+static const uint8_t PANEL_SLPIN = 0x10;
+static const uint8_t PANEL_SLPOUT = 0x11;
+static const uint8_t PANEL_INVOFF = 0x20;
+static const uint8_t PANEL_INVON = 0x21;
+static const uint8_t PANEL_VSCRDEF = 0x33;
+static const uint8_t PANEL_MADCTL = 0x36;
+static const uint8_t PANEL_VSCRSADD = 0x37;
+static const uint8_t PANEL_IDMOFF = 0x38;
+static const uint8_t PANEL_IDMON = 0x39;
+static const uint8_t PANEL_FRMCTR1 = 0xB1;
+static const uint8_t PANEL_FRMCTR2 = 0xB2;
+
+static const uint32_t PANEL_SLPOUT_SETTLE_MS = 5;
+static const uint32_t PANEL_SLPOUT_TO_SLPIN_MS = 120;
+
+static const uint8_t PANEL_MADCTL_ML = 0x10;
+static const uint8_t PANEL_MADCTL_MH = 0x04;
+
+// Register-level access to the ILI9341-compatible controller, whichever
+// driver owns the bus. Implementations only provide send_command(); the
+// helpers keep track of what was last written so it can be restored.
+class Panel {
+    public:
+        virtual void send_command(uint8_t command, const uint8_t *data, uint8_t length) = 0;
+        // The component whose update interval paces redraws, if the driver is polled.
+        virtual PollingComponent *poller() { return nullptr; }
+
+        void scroll_to(uint16_t line);
+        void set_scroll_margins(uint16_t top, uint16_t bottom);
+        void set_inverted(bool inverted);
+        void set_madctl(uint8_t madctl);
+        // Normal-mode refresh rate (FRMCTR1), approximated from the internal 615 kHz oscillator.
+        void set_frame_rate(float hz);
+        // Back to the FRMCTR1 value of the init sequence.
+        void restore_frame_rate();
+        // Refresh rate used in idle mode (FRMCTR2).
+        void set_idle_frame_rate(float hz);
+        // Idle mode shows 8 colours only, in exchange for lower panel power.
+        void set_idle_mode(bool idle);
+        // Does not wait; call wait_awake() before the next pixels after waking.
+        // SLPIN within 120 ms of SLPOUT is refused and returns false.
+        bool set_sleep(bool sleep);
+        // Blocks for whatever is left of the 5 ms the controller needs after SLPOUT.
+        void wait_awake();
+
+        uint16_t width() const { return this->width_; }
+        uint16_t height() const { return this->height_; }
+        bool is_inverted() const { return this->inverted_; }
+        uint8_t madctl() const { return this->madctl_; }
+        bool is_idle_mode() const { return this->idle_mode_; }
+        bool is_sleeping() const { return this->sleeping_; }
+        // Bytes (command plus parameters) and microseconds spent in send() since boot.
+        uint32_t bytes_sent() const { return this->bytes_sent_; }
+        uint32_t time_spent_us() const { return this->time_spent_us_; }
+
+        void set_size(uint16_t width, uint16_t height)
+        {
+            this->width_ = width;
+            this->height_ = height;
+        }
+        // Records state set by the driver's own init sequence.
+        void set_initial_state(uint8_t madctl, bool inverted)
+        {
+            this->madctl_ = madctl;
+            this->inverted_ = inverted;
+        }
+
+    protected:
+        void send_(uint8_t command, const uint8_t *data, uint8_t length);
+        void send_frame_rate_(uint8_t command, float hz);
+
+        uint16_t width_{320};
+        uint16_t height_{320};
+        // MX | BGR: what both the Adafruit driver (rotation 0) and the ili9xxx
+        // config with mirror_x write. The PicoCalc panel needs INVON for true colours.
+        uint8_t madctl_{0x48};
+        bool inverted_{true};
+        // DIVA and RTNA as written by both drivers' init sequences: about 79 Hz.
+        uint8_t frame_control_[2]{0x00, 0x18};
+        bool idle_mode_{false};
+        bool sleeping_{false};
+        // millis() of the last SLPOUT; 0 before the first.
+        uint32_t sleep_out_ms_{0};
+        uint32_t bytes_sent_{0};
+        uint32_t time_spent_us_{0};
+};
+
+}  // namespace picocalc
+}  // namespace esphome
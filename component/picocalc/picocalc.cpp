@@ -1,7 +1,12 @@
 #include "picocalc.h"
+#include <cmath>
 #include "esphome/core/log.h"
 #include "esphome/core/helpers.h"
 
+#ifdef USE_LVGL
+#include <lvgl.h>
+#endif
+
 namespace esphome
 {
     namespace picocalc
@@ -12,17 +17,405 @@ namespace esphome
         {
             ESP_LOGI(TAG, "PicoCalc Online!");
             ESP_LOGCONFIG(TAG, "Setting up PicoCalc");
+            if (this->burn_in_ != nullptr)
+                this->burn_in_->set_panel(this->panel_);
+            if (this->idle_ != nullptr)
+            {
+                this->idle_->set_panel(this->panel_);
+#ifdef USE_LVGL
+                // Every flushed frame counts as activity, so content changes wake the panel.
+                this->display_tap_.add_listener(this->idle_);
+#endif
+            }
+#ifdef USE_LVGL
+            // Queued label text goes into LVGL right before each render, never twice per frame.
+            this->display_tap_.set_refresh_hook([this]() { this->apply_updates_(); });
+            this->display_tap_.set_heap_probe(this->get_render_heap_probe());
+            if (this->latency_ != nullptr)
+                this->display_tap_.add_listener(this->latency_);
+            if (this->host_panel_ != nullptr)
+                this->display_tap_.add_listener(this->host_panel_);
+#endif
+#ifdef USE_PICOCALC_KEYBOARD
+            if (this->keyboard_ != nullptr)
+            {
+                // Ahead of the on_key triggers, so a press is traced before anything reacts to it.
+                this->keyboard_->set_input_hook([this](uint8_t key, uint8_t state, uint32_t read_us) {
+                    this->notify_activity();
+                    if (this->latency_ != nullptr && state == KEY_PRESSED)
+                        this->latency_->input(key, read_us);
+                });
+                this->set_interval("keyboard", this->keyboard_->poll_interval(), [this]() { this->keyboard_->poll(); });
+            }
+#endif
+#ifdef USE_PICOCALC_BUS_STATS
+            this->set_interval("bus_stats", this->bus_stats_interval_, [this]() { this->publish_bus_stats_(); });
+#endif
+#ifdef USE_PICOCALC_LOOP_TRACE
+            this->main_loop_slot_ = this->loop_tracer_.register_slot("main_loop");
+            if (this->loop_pass_marker_ != nullptr)
+                this->loop_pass_marker_->set_tracer(&this->loop_tracer_, this->main_loop_slot_);
+            this->picocalc_slot_ = this->loop_tracer_.register_slot("picocalc");
+            this->set_interval("loop_trace", this->loop_trace_interval_, [this]() { this->publish_loop_trace_(); });
+#endif
+#ifdef USE_PICOCALC_MEMORY
+            this->set_interval("memory", this->memory_interval_, [this]() { this->publish_memory_(); });
+            this->frame_arena_budget_ = this->memory_monitor_.register_budget("frame_arena", this->frame_arena_.capacity());
+#ifdef USE_LVGL
+            this->label_budget_ = this->memory_monitor_.register_budget("label_text", LabelTextCache::storage_size());
+            // Part of PicoCalc itself, so held from boot.
+            this->memory_monitor_.set_used(this->memory_monitor_.register_budget("update_queue", UpdateQueue::storage_size()),
+                                           UpdateQueue::storage_size());
+#endif
+#endif
+            this->set_interval("allocators", this->allocators_interval_, [this]() { this->publish_allocators_(); });
+#ifdef USE_LVGL
+            if (this->page_cache_ != nullptr)
+            {
+                bool allocated = this->page_cache_->setup(&this->display_tap_, &this->update_queue_);
+#ifdef USE_PICOCALC_MEMORY
+                uint8_t budget = this->memory_monitor_.register_budget("page_cache", this->page_cache_->storage_size());
+                if (allocated)
+                    this->memory_monitor_.set_used(budget, this->page_cache_->storage_size());
+#endif
+                if (!allocated)
+                    ESP_LOGW(TAG, "Page cache disabled, out of memory");
+            }
+#ifdef USE_PICOCALC_MIRROR
+            if (this->mirror_ != nullptr)
+                this->mirror_->setup(&this->display_tap_);
+#endif
+            if (this->log_sink_ != nullptr)
+            {
+                bool allocated = this->log_sink_->setup();
+#ifdef USE_PICOCALC_MEMORY
+                uint8_t budget = this->memory_monitor_.register_budget("log_ring", this->log_sink_->storage_size());
+                if (allocated)
+                    this->memory_monitor_.set_used(budget, this->log_sink_->storage_size());
+#endif
+                if (!allocated)
+                    ESP_LOGW(TAG, "Log sink disabled, out of memory");
+            }
+            this->set_interval("update_queue", this->update_queue_interval_, [this]() { this->publish_update_queue_(); });
+#endif
          }
 
         void PicoCalc::dump_config()
         {
             ESP_LOGI(TAG, "PicoCalc Online!");
             ESP_LOGCONFIG(TAG, "PicoCalc config:");
+#ifdef USE_PICOCALC_BUS_STATS
+            ESP_LOGCONFIG(TAG, "  Bus stats interval: %u ms", (unsigned) this->bus_stats_interval_);
+            LOG_SENSOR("  ", "Commands per frame", this->commands_sensor_);
+            LOG_SENSOR("  ", "Data bytes per frame", this->data_bytes_sensor_);
+            LOG_SENSOR("  ", "Windows per frame", this->windows_sensor_);
+            LOG_SENSOR("  ", "CS toggles per frame", this->cs_toggles_sensor_);
+            LOG_SENSOR("  ", "Bus time per frame", this->busy_time_sensor_);
+            global_bus_stats.log_summary(TAG);
+#endif
+#ifdef USE_PICOCALC_LOOP_TRACE
+            ESP_LOGCONFIG(TAG, "  Loop trace interval: %u ms", (unsigned) this->loop_trace_interval_);
+            ESP_LOGCONFIG(TAG, "  Slow call threshold: %u us", (unsigned) this->loop_tracer_.slow_threshold());
+            LOG_SENSOR("  ", "Loop time p99", this->loop_time_p99_sensor_);
+            LOG_SENSOR("  ", "Loop time max", this->loop_time_max_sensor_);
+            LOG_SENSOR("  ", "Slow calls", this->slow_calls_sensor_);
+#endif
+            ESP_LOGCONFIG(TAG, "  Panel control: %s", this->panel_ != nullptr ? "yes" : "no");
+            if (this->burn_in_ != nullptr)
+                this->burn_in_->dump_config(TAG);
+            if (this->idle_ != nullptr)
+                this->idle_->dump_config(TAG);
+            if (this->latency_ != nullptr)
+                this->latency_->dump_config(TAG);
+            if (this->host_panel_ != nullptr)
+                this->host_panel_->dump_config(TAG);
+#ifdef USE_PICOCALC_KEYBOARD
+            if (this->keyboard_ != nullptr)
+                ESP_LOGCONFIG(TAG, "  Keyboard poll interval: %u ms", (unsigned) this->keyboard_->poll_interval());
+#endif
+            ESP_LOGCONFIG(TAG, "  Frame arena: %u B", (unsigned) this->frame_arena_.capacity());
+#ifdef USE_LVGL
+            ESP_LOGCONFIG(TAG, "  Label slots: %u", (unsigned) PICOCALC_LABEL_SLOTS);
+            LOG_SENSOR("  ", "Updates enqueued", this->updates_enqueued_sensor_);
+            LOG_SENSOR("  ", "Updates applied", this->updates_applied_sensor_);
+            LOG_SENSOR("  ", "Updates suppressed", this->updates_suppressed_sensor_);
+            if (this->page_cache_ != nullptr)
+                this->page_cache_->dump_config(TAG);
+#ifdef USE_PICOCALC_MIRROR
+            if (this->mirror_ != nullptr)
+                this->mirror_->dump_config(TAG);
+#endif
+            if (this->log_sink_ != nullptr)
+                this->log_sink_->dump_config(TAG);
+#endif
+            LOG_SENSOR("  ", "Arena high water", this->arena_high_water_sensor_);
+            LOG_SENSOR("  ", "Pool slots in use", this->pool_in_use_sensor_);
+            LOG_SENSOR("  ", "Allocation failures", this->alloc_failures_sensor_);
+            LOG_SENSOR("  ", "Render heap allocations", this->render_heap_allocations_sensor_);
+#ifdef USE_PICOCALC_MEMORY
+            ESP_LOGCONFIG(TAG, "  Memory report interval: %u ms", (unsigned) this->memory_interval_);
+            for (uint8_t i = 0; i < this->memory_monitor_.budget_count(); i++)
+            {
+                const MemoryBudget &budget = this->memory_monitor_.budget(i);
+                ESP_LOGCONFIG(TAG, "  Budget %s: %u B", budget.name, (unsigned) budget.limit);
+            }
+            LOG_SENSOR("  ", "Free heap", this->free_heap_sensor_);
+            LOG_SENSOR("  ", "Largest free block", this->largest_free_block_sensor_);
+            LOG_SENSOR("  ", "Stack high water", this->stack_high_water_sensor_);
+            LOG_SENSOR("  ", "Display memory", this->display_memory_sensor_);
+#endif
         }
 
         void PicoCalc::loop()
         {
+            this->frame_arena_.reset();
+#ifdef USE_PICOCALC_LOOP_TRACE
+            LoopTraceScope trace(&this->loop_tracer_, this->picocalc_slot_);
+#endif
+            if (this->burn_in_ != nullptr)
+                this->burn_in_->loop();
+            if (this->idle_ != nullptr)
+                this->idle_->loop();
+            if (this->latency_ != nullptr)
+                this->latency_->loop();
+#ifdef USE_LVGL
+            this->display_tap_.loop();
+            if (this->page_cache_ != nullptr)
+                this->page_cache_->loop();
+#ifdef USE_PICOCALC_MIRROR
+            if (this->mirror_ != nullptr)
+                this->mirror_->loop();
+#endif
+            if (this->log_sink_ != nullptr)
+                this->log_sink_->loop();
+#endif
+        }
+
+        void PicoCalc::notify_activity()
+        {
+            if (this->idle_ != nullptr)
+                this->idle_->notify_activity();
+        }
+
+        void PicoCalc::mark_state_changed()
+        {
+            if (this->latency_ != nullptr)
+                this->latency_->state_changed();
+        }
+
+        void PicoCalc::set_host_panel(HostPanel *panel)
+        {
+            this->host_panel_ = panel;
+            this->set_panel(panel);
+        }
+
+        bool PicoCalc::start_burn_in()
+        {
+            return this->burn_in_ != nullptr && this->burn_in_->start();
+        }
+
+        void PicoCalc::stop_burn_in()
+        {
+            if (this->burn_in_ != nullptr)
+                this->burn_in_->stop();
+        }
+
+        LoopTracer *PicoCalc::get_loop_tracer()
+        {
+#ifdef USE_PICOCALC_LOOP_TRACE
+            return &this->loop_tracer_;
+#else
+            return nullptr;
+#endif
+        }
+
+        HeapProbe *PicoCalc::get_render_heap_probe()
+        {
+#ifdef USE_PICOCALC_HEAP_PROBE
+            return &this->render_heap_probe_;
+#else
+            return nullptr;
+#endif
+        }
+
+        void PicoCalc::set_memory_used(const char *name, uint32_t used)
+        {
+#ifdef USE_PICOCALC_MEMORY
+            uint8_t handle = this->memory_monitor_.find(name);
+            if (handle == MEMORY_NO_BUDGET)
+                ESP_LOGW(TAG, "No memory budget named %s", name);
+            this->memory_monitor_.set_used(handle, used);
+#endif
+        }
+
+        MemoryMonitor *PicoCalc::get_memory_monitor()
+        {
+#ifdef USE_PICOCALC_MEMORY
+            return &this->memory_monitor_;
+#else
+            return nullptr;
+#endif
+        }
 
+#ifdef USE_LVGL
+        void PicoCalc::set_label_text(lv_obj_t *label, const char *fmt, ...)
+        {
+            va_list args;
+            va_start(args, fmt);
+            this->update_queue_.enqueue(label, fmt, args);
+            va_end(args);
+        }
+
+        void PicoCalc::set_page_cache_enabled(bool enabled)
+        {
+            if (this->page_cache_ != nullptr)
+                this->page_cache_->set_enabled(enabled);
+        }
+
+        void PicoCalc::clear_page_cache()
+        {
+            if (this->page_cache_ != nullptr)
+                this->page_cache_->clear();
+        }
+
+        void PicoCalc::set_log_textarea(lv_obj_t *textarea)
+        {
+            if (this->log_sink_ != nullptr)
+                this->log_sink_->set_textarea(textarea);
+        }
+
+        void PicoCalc::apply_updates_()
+        {
+            HeapProbeScope probe(this->get_render_heap_probe());
+            uint32_t epoch = this->update_queue_.epoch();
+            this->update_queue_.apply();
+            if (this->update_queue_.epoch() != epoch)
+                this->mark_state_changed();
+        }
+
+        void PicoCalc::publish_update_queue_()
+        {
+            const UpdateQueueStats &stats = this->update_queue_.stats();
+            ESP_LOGD(TAG, "Update queue: %u enqueued, %u applied, %u suppressed", (unsigned) stats.enqueued,
+                     (unsigned) stats.applied, (unsigned) stats.suppressed);
+            if (this->updates_enqueued_sensor_ != nullptr)
+                this->updates_enqueued_sensor_->publish_state(stats.enqueued);
+            if (this->updates_applied_sensor_ != nullptr)
+                this->updates_applied_sensor_->publish_state(stats.applied);
+            if (this->updates_suppressed_sensor_ != nullptr)
+                this->updates_suppressed_sensor_->publish_state(stats.suppressed);
+        }
+#endif
+
+        void PicoCalc::publish_allocators_()
+        {
+            const AllocStats &arena = this->frame_arena_.stats();
+            uint32_t pool_in_use = 0;
+            uint32_t failures = arena.failures;
+#ifdef USE_LVGL
+            pool_in_use += this->update_queue_.alloc_stats().in_use;
+            failures += this->update_queue_.alloc_stats().failures;
+#endif
+            ESP_LOGD(TAG, "Allocators: arena high water %u/%u B, %u pool slots in use, %u failures, %u render heap allocations",
+                     (unsigned) arena.high_water, (unsigned) this->frame_arena_.capacity(), (unsigned) pool_in_use,
+                     (unsigned) failures, (unsigned) this->render_heap_probe_.allocations());
+#ifdef USE_PICOCALC_MEMORY
+            this->memory_monitor_.set_used(this->frame_arena_budget_, arena.high_water);
+#ifdef USE_LVGL
+            this->memory_monitor_.set_used(this->label_budget_, this->update_queue_.alloc_stats().in_use * sizeof(LabelText));
+#endif
+#endif
+            if (this->arena_high_water_sensor_ != nullptr)
+                this->arena_high_water_sensor_->publish_state(arena.high_water);
+            if (this->pool_in_use_sensor_ != nullptr)
+                this->pool_in_use_sensor_->publish_state(pool_in_use);
+            if (this->alloc_failures_sensor_ != nullptr)
+                this->alloc_failures_sensor_->publish_state(failures);
+            if (this->render_heap_allocations_sensor_ != nullptr)
+                this->render_heap_allocations_sensor_->publish_state(this->render_heap_probe_.allocations());
+        }
+
+#ifdef USE_PICOCALC_BUS_STATS
+        void PicoCalc::publish_bus_stats_()
+        {
+            const BusFrame &period = global_bus_stats.period();
+            uint32_t frames = global_bus_stats.period_frames();
+            global_bus_stats.log_summary(TAG);
+            if (frames != 0)
+            {
+                if (this->commands_sensor_ != nullptr)
+                    this->commands_sensor_->publish_state(float(period.commands) / frames);
+                if (this->data_bytes_sensor_ != nullptr)
+                    this->data_bytes_sensor_->publish_state(float(period.data_bytes) / frames);
+                if (this->windows_sensor_ != nullptr)
+                    this->windows_sensor_->publish_state(float(period.windows) / frames);
+                if (this->cs_toggles_sensor_ != nullptr)
+                    this->cs_toggles_sensor_->publish_state(float(period.cs_toggles) / frames);
+                if (this->busy_time_sensor_ != nullptr)
+                    this->busy_time_sensor_->publish_state(float(period.busy_us) / frames);
+            }
+            global_bus_stats.reset_period();
+        }
+#endif
+
+#ifdef USE_PICOCALC_LOOP_TRACE
+        void PicoCalc::publish_loop_trace_()
+        {
+            this->loop_tracer_.dump(TAG);
+            const LoopTraceSlot &main_loop = this->loop_tracer_.slot(this->main_loop_slot_);
+            if (this->loop_time_p99_sensor_ != nullptr && main_loop.count != 0)
+                this->loop_time_p99_sensor_->publish_state(this->loop_tracer_.percentile_us(this->main_loop_slot_, 99));
+            if (this->loop_time_max_sensor_ != nullptr && main_loop.count != 0)
+                this->loop_time_max_sensor_->publish_state(main_loop.max_us);
+            if (this->slow_calls_sensor_ != nullptr)
+                this->slow_calls_sensor_->publish_state(this->loop_tracer_.slow_calls());
+            this->loop_tracer_.reset();
+        }
+#endif
+
+#ifdef USE_PICOCALC_MEMORY
+        void PicoCalc::publish_memory_()
+        {
+#ifdef USE_LVGL
+            // LVGL allocates its draw buffers after we are set up, so account for them lazily.
+            lv_disp_t *disp = lv_disp_get_default();
+            if (disp != nullptr && disp->driver->draw_buf != nullptr)
+            {
+                lv_disp_draw_buf_t *draw_buf = disp->driver->draw_buf;
+                uint32_t bytes = draw_buf->size * sizeof(lv_color_t) * (draw_buf->buf2 != nullptr ? 2 : 1);
+                if (this->lvgl_draw_buf_budget_ == MEMORY_NO_BUDGET)
+                    this->lvgl_draw_buf_budget_ = this->memory_monitor_.register_budget("lvgl_draw_buf", bytes);
+                this->memory_monitor_.set_used(this->lvgl_draw_buf_budget_, bytes);
+            }
+            ScreenShadow *shadow = this->display_tap_.get_shadow();
+            if (shadow != nullptr && this->shadow_budget_ == MEMORY_NO_BUDGET)
+            {
+                this->shadow_budget_ = this->memory_monitor_.register_budget("screen_shadow", shadow->storage_size());
+                this->memory_monitor_.set_used(this->shadow_budget_, shadow->storage_size());
+            }
+#ifdef USE_PICOCALC_MIRROR
+            if (this->mirror_ != nullptr && this->mirror_->storage_size() != 0 && this->mirror_budget_ == MEMORY_NO_BUDGET)
+            {
+                this->mirror_budget_ = this->memory_monitor_.register_budget("mirror_strip", this->mirror_->storage_size());
+                this->memory_monitor_.set_used(this->mirror_budget_, this->mirror_->storage_size());
+            }
+#endif
+#endif
+            this->memory_monitor_.log_report(TAG);
+            HeapInfo heap = this->memory_monitor_.heap_info();
+            if (this->free_heap_sensor_ != nullptr)
+                this->free_heap_sensor_->publish_state(heap.free);
+            if (this->largest_free_block_sensor_ != nullptr)
+                this->largest_free_block_sensor_->publish_state(heap.largest_free_block);
+            if (this->stack_high_water_sensor_ != nullptr)
+            {
+                // 0 means no task stack could be inspected, which is not the same as none left.
+                uint32_t stack_free = this->memory_monitor_.stack_high_water();
+                this->stack_high_water_sensor_->publish_state(stack_free != 0 ? float(stack_free) : NAN);
+            }
+            if (this->display_memory_sensor_ != nullptr)
+                this->display_memory_sensor_->publish_state(this->memory_monitor_.total_used());
         }
+#endif
     } // namespace picocalc
-} // namespace esphome
\ No newline at end of file
+} // namespace esphome
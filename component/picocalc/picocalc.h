@@ -1,5 +1,27 @@
 #pragma once
 #include "esphome/core/component.h"
+#include "esphome/components/sensor/sensor.h"
+
+#include "arena.h"
+#include "burn_in.h"
+#include "bus_stats.h"
+#include "display_tap.h"
+#include "host_panel.h"
+#include "idle_manager.h"
+#include "ili9xxx_panel.h"
+#include "keyboard.h"
+#include "latency_trace.h"
+#include "log_sink.h"
+#include "loop_trace.h"
+#include "memory_monitor.h"
+#include "page_cache.h"
+#include "panel.h"
+#include "screen_mirror.h"
+#include "update_queue.h"
+
+#ifndef PICOCALC_FRAME_ARENA_SIZE
+#define PICOCALC_FRAME_ARENA_SIZE 2048
+#endif
 
 namespace esphome {
 namespace picocalc {
@@ -9,6 +31,164 @@ class PicoCalc : public Component {
         void setup() override;
         void dump_config() override;
         void loop() override;
+
+        // Shared by the other picocalc components; nullptr unless loop_trace is configured.
+        LoopTracer *get_loop_tracer();
+        // Display subsystems register their budgets here; nullptr unless memory is configured.
+        MemoryMonitor *get_memory_monitor();
+        // Reports what a budget declared under memory: budgets: holds, e.g. from a lambda.
+        void set_memory_used(const char *name, uint32_t used);
+        // Scratch memory for formatting and draw helpers. Everything in it is
+        // released at the start of the next main loop pass.
+        Arena &get_frame_arena() { return this->frame_arena_; }
+        // Wrap render-path code in a HeapProbeScope on this to prove it stays off the heap.
+        // nullptr unless render_heap_allocations is configured.
+        HeapProbe *get_render_heap_probe();
+        // Register-level access to the display controller, from whichever driver owns it.
+        void set_panel(Panel *panel) { this->panel_ = panel; }
+        Panel *get_panel() { return this->panel_; }
+        void set_burn_in(BurnIn *burn_in) { this->burn_in_ = burn_in; }
+        // False when there is no burn_in config or no panel to drive; callers can fall back then.
+        bool start_burn_in();
+        void stop_burn_in();
+        void set_idle_manager(IdleManager *idle) { this->idle_ = idle; }
+        // Counts as input for the idle manager, for activity it cannot see itself.
+        void notify_activity();
+#ifdef USE_PICOCALC_KEYBOARD
+        void set_keyboard(KeySource *keyboard) { this->keyboard_ = keyboard; }
+        KeySource *get_keyboard() { return this->keyboard_; }
+#endif
+        void set_latency_tracer(LatencyTracer *latency) { this->latency_ = latency; }
+        // For key handlers that change the screen without set_label_text(): the
+        // latency tracer takes this as the state update that follows a key press.
+        void mark_state_changed();
+        void set_host_panel(HostPanel *panel);
+#ifdef USE_LVGL
+        // printf into a label without allocating. The text is queued and applied
+        // with the next frame; repeated and unchanged updates never reach LVGL.
+        void set_label_text(lv_obj_t *label, const char *fmt, ...) __attribute__((format(printf, 3, 4)));
+        // Sees every LVGL frame on its way to the panel; installed once something listens.
+        DisplayTap *get_display_tap() { return &this->display_tap_; }
+        void set_page_cache(PageCache *page_cache) { this->page_cache_ = page_cache; }
+        void set_page_cache_enabled(bool enabled);
+        // Drops all page snapshots, e.g. after changing widgets that bypass set_label_text().
+        void clear_page_cache();
+#ifdef USE_PICOCALC_MIRROR
+        void set_mirror(ScreenMirror *mirror) { this->mirror_ = mirror; }
+#endif
+        void set_log_sink(LogSink *log_sink) { this->log_sink_ = log_sink; }
+        // Where the log sink shows its lines; call from a lambda once LVGL is up.
+        void set_log_textarea(lv_obj_t *textarea);
+        void set_update_queue_interval(uint32_t interval) { this->update_queue_interval_ = interval; }
+        void set_updates_enqueued_sensor(sensor::Sensor *sensor) { this->updates_enqueued_sensor_ = sensor; }
+        void set_updates_applied_sensor(sensor::Sensor *sensor) { this->updates_applied_sensor_ = sensor; }
+        void set_updates_suppressed_sensor(sensor::Sensor *sensor) { this->updates_suppressed_sensor_ = sensor; }
+#endif
+        void set_allocators_interval(uint32_t interval) { this->allocators_interval_ = interval; }
+        void set_arena_high_water_sensor(sensor::Sensor *sensor) { this->arena_high_water_sensor_ = sensor; }
+        void set_pool_in_use_sensor(sensor::Sensor *sensor) { this->pool_in_use_sensor_ = sensor; }
+        void set_alloc_failures_sensor(sensor::Sensor *sensor) { this->alloc_failures_sensor_ = sensor; }
+        void set_render_heap_allocations_sensor(sensor::Sensor *sensor) { this->render_heap_allocations_sensor_ = sensor; }
+
+#ifdef USE_PICOCALC_BUS_STATS
+        void set_bus_stats_interval(uint32_t interval) { this->bus_stats_interval_ = interval; }
+        void set_commands_sensor(sensor::Sensor *sensor) { this->commands_sensor_ = sensor; }
+        void set_data_bytes_sensor(sensor::Sensor *sensor) { this->data_bytes_sensor_ = sensor; }
+        void set_windows_sensor(sensor::Sensor *sensor) { this->windows_sensor_ = sensor; }
+        void set_cs_toggles_sensor(sensor::Sensor *sensor) { this->cs_toggles_sensor_ = sensor; }
+        void set_busy_time_sensor(sensor::Sensor *sensor) { this->busy_time_sensor_ = sensor; }
+#endif
+#ifdef USE_PICOCALC_LOOP_TRACE
+        void set_loop_trace_interval(uint32_t interval) { this->loop_trace_interval_ = interval; }
+        void set_slow_threshold(uint32_t threshold_us) { this->loop_tracer_.set_slow_threshold(threshold_us); }
+        // The marker that runs last in each pass; it times the main_loop slot.
+        void set_loop_pass_marker(LoopPassMarker *marker) { this->loop_pass_marker_ = marker; }
+        void set_loop_time_p99_sensor(sensor::Sensor *sensor) { this->loop_time_p99_sensor_ = sensor; }
+        void set_loop_time_max_sensor(sensor::Sensor *sensor) { this->loop_time_max_sensor_ = sensor; }
+        void set_slow_calls_sensor(sensor::Sensor *sensor) { this->slow_calls_sensor_ = sensor; }
+#endif
+#ifdef USE_PICOCALC_MEMORY
+        void set_memory_interval(uint32_t interval) { this->memory_interval_ = interval; }
+        void add_memory_budget(const char *name, uint32_t limit) { this->memory_monitor_.register_budget(name, limit); }
+        void set_free_heap_sensor(sensor::Sensor *sensor) { this->free_heap_sensor_ = sensor; }
+        void set_largest_free_block_sensor(sensor::Sensor *sensor) { this->largest_free_block_sensor_ = sensor; }
+        void set_stack_high_water_sensor(sensor::Sensor *sensor) { this->stack_high_water_sensor_ = sensor; }
+        void set_display_memory_sensor(sensor::Sensor *sensor) { this->display_memory_sensor_ = sensor; }
+#endif
+
+    protected:
+        void publish_allocators_();
+
+        Panel *panel_{nullptr};
+        BurnIn *burn_in_{nullptr};
+        IdleManager *idle_{nullptr};
+        LatencyTracer *latency_{nullptr};
+        HostPanel *host_panel_{nullptr};
+#ifdef USE_PICOCALC_KEYBOARD
+        KeySource *keyboard_{nullptr};
+#endif
+
+        StaticArena<PICOCALC_FRAME_ARENA_SIZE> frame_arena_;
+        HeapProbe render_heap_probe_;
+#ifdef USE_LVGL
+        void apply_updates_();
+        void publish_update_queue_();
+
+        UpdateQueue update_queue_;
+        DisplayTap display_tap_;
+        PageCache *page_cache_{nullptr};
+#ifdef USE_PICOCALC_MIRROR
+        ScreenMirror *mirror_{nullptr};
+#endif
+        LogSink *log_sink_{nullptr};
+        uint32_t update_queue_interval_{60000};
+        sensor::Sensor *updates_enqueued_sensor_{nullptr};
+        sensor::Sensor *updates_applied_sensor_{nullptr};
+        sensor::Sensor *updates_suppressed_sensor_{nullptr};
+#endif
+        uint32_t allocators_interval_{60000};
+        sensor::Sensor *arena_high_water_sensor_{nullptr};
+        sensor::Sensor *pool_in_use_sensor_{nullptr};
+        sensor::Sensor *alloc_failures_sensor_{nullptr};
+        sensor::Sensor *render_heap_allocations_sensor_{nullptr};
+
+#ifdef USE_PICOCALC_BUS_STATS
+        void publish_bus_stats_();
+
+        uint32_t bus_stats_interval_{10000};
+        sensor::Sensor *commands_sensor_{nullptr};
+        sensor::Sensor *data_bytes_sensor_{nullptr};
+        sensor::Sensor *windows_sensor_{nullptr};
+        sensor::Sensor *cs_toggles_sensor_{nullptr};
+        sensor::Sensor *busy_time_sensor_{nullptr};
+#endif
+#ifdef USE_PICOCALC_LOOP_TRACE
+        void publish_loop_trace_();
+
+        LoopTracer loop_tracer_;
+        uint32_t loop_trace_interval_{60000};
+        LoopPassMarker *loop_pass_marker_{nullptr};
+        uint8_t main_loop_slot_{LOOP_TRACE_NO_SLOT};
+        uint8_t picocalc_slot_{LOOP_TRACE_NO_SLOT};
+        sensor::Sensor *loop_time_p99_sensor_{nullptr};
+        sensor::Sensor *loop_time_max_sensor_{nullptr};
+        sensor::Sensor *slow_calls_sensor_{nullptr};
+#endif
+#ifdef USE_PICOCALC_MEMORY
+        void publish_memory_();
+
+        MemoryMonitor memory_monitor_;
+        uint32_t memory_interval_{30000};
+        uint8_t lvgl_draw_buf_budget_{MEMORY_NO_BUDGET};
+        uint8_t frame_arena_budget_{MEMORY_NO_BUDGET};
+        uint8_t label_budget_{MEMORY_NO_BUDGET};
+        uint8_t shadow_budget_{MEMORY_NO_BUDGET};
+        uint8_t mirror_budget_{MEMORY_NO_BUDGET};
+        sensor::Sensor *free_heap_sensor_{nullptr};
+        sensor::Sensor *largest_free_block_sensor_{nullptr};
+        sensor::Sensor *stack_high_water_sensor_{nullptr};
+        sensor::Sensor *display_memory_sensor_{nullptr};
+#endif
 };
 
 }  // namespace picocalc
@@ -0,0 +1,237 @@
+#include "screen_mirror.h"
+
+#if defined(USE_LVGL) && defined(USE_PICOCALC_MIRROR)
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include "esphome/core/hal.h"
+#include "esphome/core/log.h"
+
+namespace esphome
+{
+    namespace picocalc
+    {
+        static const char *const TAG = "picocalc.mirror";
+        static const uint8_t TILE_HEADER_SIZE = 9;
+        static const uint8_t FRAME_SIZE = 7;
+
+        static void put_u16(uint8_t *out, uint16_t value)
+        {
+            out[0] = value & 0xFF;
+            out[1] = value >> 8;
+        }
+
+        static void put_u32(uint8_t *out, uint32_t value)
+        {
+            put_u16(out, value & 0xFFFF);
+            put_u16(out + 2, value >> 16);
+        }
+
+        void ScreenMirror::setup(DisplayTap *tap)
+        {
+            this->tap_ = tap;
+            tap->request_shadow(this->tile_slot_size_);
+        }
+
+        void ScreenMirror::dump_config(const char *tag)
+        {
+            ESP_LOGCONFIG(tag, "  Screen mirror: port %u, %u B/s, bursts of %u B", (unsigned) this->port_,
+                          (unsigned) this->max_rate_, (unsigned) this->max_burst_);
+            LOG_SENSOR("  ", "Mirror bytes sent", this->bytes_sent_sensor_);
+            LOG_SENSOR("  ", "Mirror frames sent", this->frames_sent_sensor_);
+        }
+
+        bool ScreenMirror::listen_()
+        {
+            this->server_ = socket::socket_ip(SOCK_STREAM, 0);
+            if (this->server_ == nullptr)
+                return false;
+            int enable = 1;
+            this->server_->setsockopt(SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+            this->server_->setblocking(false);
+            struct sockaddr_storage address;
+            socklen_t length = socket::set_sockaddr_any((struct sockaddr *) &address, sizeof(address), this->port_);
+            if (this->server_->bind((struct sockaddr *) &address, length) != 0 || this->server_->listen(1) != 0)
+            {
+                ESP_LOGW(TAG, "Cannot listen on port %u: errno %d", (unsigned) this->port_, errno);
+                this->server_ = nullptr;
+                return false;
+            }
+            ESP_LOGI(TAG, "Listening on port %u", (unsigned) this->port_);
+            return true;
+        }
+
+        void ScreenMirror::accept_()
+        {
+            struct sockaddr_storage address;
+            socklen_t length = sizeof(address);
+            std::unique_ptr<socket::Socket> client = this->server_->accept((struct sockaddr *) &address, &length);
+            if (client == nullptr)
+                return;
+            // A new viewer replaces the old one.
+            if (this->client_ != nullptr)
+                this->disconnect_();
+            client->setblocking(false);
+            this->client_ = std::move(client);
+            ESP_LOGI(TAG, "Client connected");
+
+            ScreenShadow *shadow = this->tap_->get_shadow();
+            lv_area_t last = shadow->tile_area(shadow->tile_count() - 1);
+            memcpy(this->out_, "PCSM", 4);
+            this->out_[4] = MIRROR_VERSION;
+            this->out_[5] = SHADOW_TILE;
+            put_u16(this->out_ + 6, last.x2 + 1);
+            put_u16(this->out_ + 8, last.y2 + 1);
+            this->out_length_ = 10;
+            this->out_offset_ = 0;
+            // Everything is damaged as far as a new client is concerned.
+            for (uint16_t tile = 0; tile < shadow->tile_count(); tile++)
+                this->sent_versions_[tile] = shadow->tile_version(tile) - 1;
+            this->cursor_ = 0;
+            this->tiles_since_frame_ = 0;
+            // The new client has seen no frame yet, even if the screen has not changed since the last one.
+            this->last_frame_sent_ = this->tap_->frames() - 1;
+            this->tokens_ = this->max_burst_;
+            this->last_refill_us_ = micros();
+        }
+
+        void ScreenMirror::disconnect_()
+        {
+            this->client_->close();
+            this->client_ = nullptr;
+            this->out_length_ = this->out_offset_ = 0;
+            ESP_LOGI(TAG, "Client disconnected");
+        }
+
+        bool ScreenMirror::drain_()
+        {
+            while (this->out_offset_ < this->out_length_)
+            {
+                ssize_t written = this->client_->write(this->out_ + this->out_offset_, this->out_length_ - this->out_offset_);
+                if (written < 0)
+                {
+                    if (errno != EWOULDBLOCK && errno != EAGAIN)
+                        this->disconnect_();
+                    return false;
+                }
+                if (written == 0)
+                    return false;
+                this->out_offset_ += written;
+                this->bytes_sent_ += written;
+            }
+            this->out_length_ = this->out_offset_ = 0;
+            return true;
+        }
+
+        bool ScreenMirror::queue_(uint32_t length)
+        {
+            if (length > this->tokens_)
+                return false;
+            this->tokens_ -= length;
+            this->out_length_ = length;
+            this->out_offset_ = 0;
+            return true;
+        }
+
+        void ScreenMirror::loop()
+        {
+            if (this->tap_ == nullptr)
+                return;
+            ScreenShadow *shadow = this->tap_->get_shadow();
+            if (shadow == nullptr)
+                return;
+            if (this->sent_versions_ == nullptr)
+            {
+                // Other users may have asked for larger shadow slots than we did.
+                this->out_capacity_ = TILE_HEADER_SIZE + shadow->slot_size();
+                this->out_ = new (std::nothrow) uint8_t[this->out_capacity_];
+                this->sent_versions_ = new (std::nothrow) uint32_t[shadow->tile_count()];
+                // The budget has to fit the largest tile or that tile would never go out.
+                this->max_burst_ = std::max(this->max_burst_, this->out_capacity_);
+                if (this->out_ == nullptr || this->sent_versions_ == nullptr || !this->listen_())
+                {
+                    // Give up for good; the mirror is a debugging aid.
+                    this->tap_ = nullptr;
+                    return;
+                }
+                this->storage_size_ = this->out_capacity_ + shadow->tile_count() * sizeof(uint32_t);
+            }
+            uint32_t now = millis();
+            if (now - this->last_publish_ms_ >= this->update_interval_)
+            {
+                this->last_publish_ms_ = now;
+                this->publish_();
+            }
+            this->accept_();
+            if (this->client_ == nullptr)
+                return;
+            uint8_t discard[16];
+            ssize_t received = this->client_->read(discard, sizeof(discard));
+            if (received == 0 || (received < 0 && errno != EWOULDBLOCK && errno != EAGAIN))
+            {
+                this->disconnect_();
+                return;
+            }
+
+            uint32_t now_us = micros();
+            uint64_t refill = uint64_t(now_us - this->last_refill_us_) * this->max_rate_ / 1000000;
+            if (refill != 0)
+            {
+                this->tokens_ = std::min<uint64_t>(this->tokens_ + refill, this->max_burst_);
+                this->last_refill_us_ = now_us;
+            }
+            if (this->drain_())
+                this->sync_(shadow);
+        }
+
+        void ScreenMirror::sync_(ScreenShadow *shadow)
+        {
+            uint16_t tiles = shadow->tile_count();
+            uint32_t frame = this->tap_->frames();
+            for (uint16_t checked = 0; checked < tiles; checked++)
+            {
+                uint16_t tile = this->cursor_;
+                uint32_t version = shadow->tile_version(tile);
+                if (version != this->sent_versions_[tile])
+                {
+                    uint16_t length = shadow->tile_length(tile);
+                    uint16_t size = length & SHADOW_TILE_LENGTH_MASK;
+                    if (!this->queue_(TILE_HEADER_SIZE + size))
+                        return;
+                    this->out_[0] = MIRROR_TILE;
+                    put_u32(this->out_ + 1, frame);
+                    put_u16(this->out_ + 5, tile);
+                    put_u16(this->out_ + 7, length);
+                    memcpy(this->out_ + TILE_HEADER_SIZE, shadow->tile_data(tile), size);
+                    this->sent_versions_[tile] = version;
+                    this->tiles_since_frame_++;
+                    if (!this->drain_())
+                        return;
+                }
+                this->cursor_ = (this->cursor_ + 1) % tiles;
+            }
+            // A full pass found nothing new: the client now shows `frame`.
+            if (this->tiles_since_frame_ == 0 || frame == this->last_frame_sent_ || !this->queue_(FRAME_SIZE))
+                return;
+            this->out_[0] = MIRROR_FRAME;
+            put_u32(this->out_ + 1, frame);
+            put_u16(this->out_ + 5, this->tiles_since_frame_);
+            this->tiles_since_frame_ = 0;
+            this->last_frame_sent_ = frame;
+            this->frames_sent_++;
+            this->drain_();
+        }
+
+        void ScreenMirror::publish_()
+        {
+            if (this->bytes_sent_sensor_ != nullptr)
+                this->bytes_sent_sensor_->publish_state(this->bytes_sent_);
+            if (this->frames_sent_sensor_ != nullptr)
+                this->frames_sent_sensor_->publish_state(this->frames_sent_);
+        }
+    } // namespace picocalc
+} // namespace esphome
+
+#endif  // USE_LVGL && USE_PICOCALC_MIRROR
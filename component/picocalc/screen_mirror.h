@@ -0,0 +1,83 @@
+#pragma once
+#include "esphome/core/defines.h"
+
+#if defined(USE_LVGL) && defined(USE_PICOCALC_MIRROR)
+#include <cstdint>
+#include <memory>
+#include "esphome/components/sensor/sensor.h"
+#include "esphome/components/socket/socket.h"
+#include "display_tap.h"
+
+namespace esphome {
+namespace picocalc {
+
+static const uint8_t MIRROR_VERSION = 1;
+static const uint8_t MIRROR_TILE = 0x01;
+static const uint8_t MIRROR_FRAME = 0x02;
+
+// Streams the screen shadow to one TCP client at a time. Only tiles whose
+// version changed since they were last sent go out, each tagged with the
+// frame it belongs to. Little endian on the wire:
+//   hello  "PCSM" version:u8 tile_size:u8 width:u16 height:u16
+//   tile   0x01 frame:u32 tile:u16 length:u16 runs[length & SHADOW_TILE_LENGTH_MASK]
+//   frame  0x02 frame:u32 tiles:u16    (client is now in sync with `frame`)
+// Sending happens from loop() with non-blocking writes and a byte budget,
+// so a slow link only delays the mirror, never rendering.
+class ScreenMirror {
+    public:
+        void set_port(uint16_t port) { this->port_ = port; }
+        void set_max_rate(uint32_t bytes_per_second) { this->max_rate_ = bytes_per_second; }
+        void set_max_burst(uint32_t bytes) { this->max_burst_ = bytes; }
+        void set_tile_slot_size(uint16_t slot_size) { this->tile_slot_size_ = slot_size; }
+        void set_update_interval(uint32_t interval) { this->update_interval_ = interval; }
+        void set_bytes_sent_sensor(sensor::Sensor *sensor) { this->bytes_sent_sensor_ = sensor; }
+        void set_frames_sent_sensor(sensor::Sensor *sensor) { this->frames_sent_sensor_ = sensor; }
+
+        void setup(DisplayTap *tap);
+        void loop();
+        void dump_config(const char *tag);
+        bool has_client() const { return this->client_ != nullptr; }
+        // Tile strip buffer and per-tile versions; 0 until the first loop() allocates them.
+        size_t storage_size() const { return this->storage_size_; }
+
+    protected:
+        bool listen_();
+        void accept_();
+        void disconnect_();
+        bool drain_();
+        bool queue_(uint32_t length);
+        void sync_(ScreenShadow *shadow);
+        void publish_();
+
+        uint16_t port_{6063};
+        uint32_t max_rate_{100000};
+        uint32_t max_burst_{4096};
+        uint16_t tile_slot_size_{384};
+        uint32_t update_interval_{60000};
+
+        DisplayTap *tap_{nullptr};
+        std::unique_ptr<socket::Socket> server_;
+        std::unique_ptr<socket::Socket> client_;
+        uint8_t *out_{nullptr};
+        uint32_t out_capacity_{0};
+        uint32_t out_length_{0};
+        uint32_t out_offset_{0};
+        uint32_t *sent_versions_{nullptr};
+        size_t storage_size_{0};
+        uint16_t cursor_{0};
+        uint16_t tiles_since_frame_{0};
+        uint32_t last_frame_sent_{0};
+        uint32_t tokens_{0};
+        uint32_t last_refill_us_{0};
+        uint32_t last_publish_ms_{0};
+        uint32_t bytes_sent_{0};
+        uint32_t frames_sent_{0};
+
+        sensor::Sensor *bytes_sent_sensor_{nullptr};
+        sensor::Sensor *frames_sent_sensor_{nullptr};
+};
+
+}  // namespace picocalc
+}  // namespace esphome
+
+#endif  // USE_LVGL && USE_PICOCALC_MIRROR
@@ -0,0 +1,218 @@
+#include "screen_shadow.h"
+
+#ifdef USE_LVGL
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+namespace esphome
+{
+    namespace picocalc
+    {
+        static_assert(sizeof(lv_color_t) == 2, "the screen shadow expects 16-bit LVGL colours");
+
+        static const uint8_t RUN_HOLE = 0x80;
+        static const uint8_t RUN_MAX = 128;
+        // Drops the lowest bit of each RGB565 channel so anti-aliasing shades merge into longer runs.
+        static const uint16_t LOSSY_MASK = 0xF7DE;
+
+        bool ScreenShadow::init(uint16_t width, uint16_t height, uint16_t slot_size)
+        {
+            if (this->slots_ != nullptr)
+                return true;
+            this->width_ = width;
+            this->height_ = height;
+            this->cols_ = (width + SHADOW_TILE - 1) / SHADOW_TILE;
+            this->rows_ = (height + SHADOW_TILE - 1) / SHADOW_TILE;
+            this->slot_size_ = std::min<uint16_t>(slot_size, SHADOW_TILE_LENGTH_MASK);
+            uint16_t tiles = this->tile_count();
+            // Allocated once and kept for the lifetime of the device.
+            this->slots_ = new (std::nothrow) uint8_t[size_t(tiles) * this->slot_size_];
+            this->lengths_ = new (std::nothrow) uint16_t[tiles];
+            this->versions_ = new (std::nothrow) uint32_t[tiles]();
+            if (this->slots_ == nullptr || this->lengths_ == nullptr || this->versions_ == nullptr)
+            {
+                delete[] this->slots_;
+                delete[] this->lengths_;
+                delete[] this->versions_;
+                this->slots_ = nullptr;
+                return false;
+            }
+            for (uint16_t i = 0; i < tiles; i++)
+                this->lengths_[i] = SHADOW_TILE_PARTIAL;
+            return true;
+        }
+
+        size_t ScreenShadow::storage_size() const
+        {
+            return size_t(this->tile_count()) * (this->slot_size_ + sizeof(uint16_t) + sizeof(uint32_t));
+        }
+
+        lv_area_t ScreenShadow::tile_area(uint16_t tile) const
+        {
+            lv_area_t area;
+            area.x1 = (tile % this->cols_) * SHADOW_TILE;
+            area.y1 = (tile / this->cols_) * SHADOW_TILE;
+            area.x2 = std::min<lv_coord_t>(area.x1 + SHADOW_TILE, this->width_) - 1;
+            area.y2 = std::min<lv_coord_t>(area.y1 + SHADOW_TILE, this->height_) - 1;
+            return area;
+        }
+
+        bool ScreenShadow::is_exact(uint16_t tile) const
+        {
+            return (this->lengths_[tile] & (SHADOW_TILE_LOSSY | SHADOW_TILE_PARTIAL)) == 0;
+        }
+
+        void ScreenShadow::decode_(uint16_t tile, uint16_t width, uint16_t count)
+        {
+            const uint8_t *data = this->tile_data(tile);
+            uint16_t length = this->lengths_[tile] & SHADOW_TILE_LENGTH_MASK;
+            uint16_t written = 0;
+            memset(this->holes_, 0, sizeof(this->holes_));
+            for (uint16_t i = 0; i < length && written < count;)
+            {
+                uint8_t run = data[i];
+                if (run & RUN_HOLE)
+                {
+                    for (uint16_t n = (run & ~RUN_HOLE) + 1; n > 0 && written < count; n--, written++)
+                        this->holes_[written / width] |= 1u << (written % width);
+                    i++;
+                    continue;
+                }
+                uint16_t color = data[i + 1] | (data[i + 2] << 8);
+                for (uint16_t n = run + 1; n > 0 && written < count; n--)
+                    this->scratch_[written++] = color;
+                i += 3;
+            }
+            // Whatever the data does not cover is unknown.
+            for (; written < count; written++)
+                this->holes_[written / width] |= 1u << (written % width);
+        }
+
+        uint16_t ScreenShadow::encode_(uint16_t width, uint16_t count, uint16_t mask, uint8_t *out, bool *partial) const
+        {
+            uint16_t length = 0;
+            uint16_t i = 0;
+            *partial = false;
+            while (i < count)
+            {
+                bool hole = (this->holes_[i / width] >> (i % width)) & 1;
+                uint16_t color = this->scratch_[i] & mask;
+                uint16_t run = 1;
+                while (i + run < count && run < RUN_MAX)
+                {
+                    uint16_t next = i + run;
+                    bool next_hole = (this->holes_[next / width] >> (next % width)) & 1;
+                    if (next_hole != hole || (!hole && (this->scratch_[next] & mask) != color))
+                        break;
+                    run++;
+                }
+                uint16_t needed = hole ? 1 : 3;
+                if (length + needed > this->slot_size_)
+                    return 0;
+                if (hole)
+                {
+                    out[length++] = RUN_HOLE | (run - 1);
+                    *partial = true;
+                }
+                else
+                {
+                    out[length++] = run - 1;
+                    out[length++] = color & 0xFF;
+                    out[length++] = color >> 8;
+                }
+                i += run;
+            }
+            return length;
+        }
+
+        void ScreenShadow::encode_tile_(uint16_t tile, uint16_t width, uint16_t count, bool lossy)
+        {
+            uint8_t *slot = this->slots_ + size_t(tile) * this->slot_size_;
+            bool partial = false;
+            uint16_t length = lossy ? 0 : this->encode_(width, count, 0xFFFF, slot, &partial);
+            if (length == 0)
+            {
+                length = this->encode_(width, count, LOSSY_MASK, slot, &partial);
+                lossy = true;
+            }
+            if (length == 0)
+                this->lengths_[tile] = SHADOW_TILE_PARTIAL;
+            else
+                this->lengths_[tile] = length | (lossy ? SHADOW_TILE_LOSSY : 0) | (partial ? SHADOW_TILE_PARTIAL : 0);
+            this->versions_[tile]++;
+        }
+
+        const uint16_t *ScreenShadow::expand(uint16_t tile)
+        {
+            if (this->lengths_[tile] & SHADOW_TILE_PARTIAL)
+                return nullptr;
+            lv_area_t area = this->tile_area(tile);
+            uint16_t width = area.x2 - area.x1 + 1;
+            this->decode_(tile, width, width * (area.y2 - area.y1 + 1));
+            return this->scratch_;
+        }
+
+        void ScreenShadow::patch(const lv_area_t &area, const lv_color_t *pixels)
+        {
+            if (this->slots_ == nullptr)
+                return;
+            const uint16_t *source = reinterpret_cast<const uint16_t *>(pixels);
+            lv_coord_t stride = area.x2 - area.x1 + 1;
+            uint16_t col_end = std::min<uint16_t>(area.x2 / SHADOW_TILE, this->cols_ - 1);
+            uint16_t row_end = std::min<uint16_t>(area.y2 / SHADOW_TILE, this->rows_ - 1);
+            for (uint16_t row = std::max<lv_coord_t>(area.y1, 0) / SHADOW_TILE; row <= row_end; row++)
+            {
+                for (uint16_t col = std::max<lv_coord_t>(area.x1, 0) / SHADOW_TILE; col <= col_end; col++)
+                {
+                    uint16_t tile = row * this->cols_ + col;
+                    lv_area_t bounds = this->tile_area(tile);
+                    lv_coord_t x1 = std::max(bounds.x1, area.x1), x2 = std::min(bounds.x2, area.x2);
+                    lv_coord_t y1 = std::max(bounds.y1, area.y1), y2 = std::min(bounds.y2, area.y2);
+                    uint16_t width = bounds.x2 - bounds.x1 + 1;
+                    uint16_t count = width * (bounds.y2 - bounds.y1 + 1);
+                    bool covers = x1 == bounds.x1 && x2 == bounds.x2 && y1 == bounds.y1 && y2 == bounds.y2;
+                    bool lossy = false;
+                    if (covers)
+                    {
+                        memset(this->holes_, 0, sizeof(this->holes_));
+                    }
+                    else
+                    {
+                        this->decode_(tile, width, count);
+                        lossy = this->lengths_[tile] & SHADOW_TILE_LOSSY;
+                    }
+                    uint32_t row_mask = (x2 - x1 + 1 >= 32 ? 0xFFFFFFFFu : ((1u << (x2 - x1 + 1)) - 1)) << (x1 - bounds.x1);
+                    for (lv_coord_t y = y1; y <= y2; y++)
+                    {
+                        memcpy(&this->scratch_[(y - bounds.y1) * width + (x1 - bounds.x1)],
+                               &source[(y - area.y1) * stride + (x1 - area.x1)], (x2 - x1 + 1) * sizeof(uint16_t));
+                        this->holes_[y - bounds.y1] &= ~row_mask;
+                    }
+                    this->encode_tile_(tile, width, count, lossy);
+                }
+            }
+        }
+
+        void ScreenShadow::forget(uint16_t tile)
+        {
+            if (this->lengths_[tile] == SHADOW_TILE_PARTIAL)
+                return;
+            this->lengths_[tile] = SHADOW_TILE_PARTIAL;
+            this->versions_[tile]++;
+        }
+
+        bool ScreenShadow::store(uint16_t tile, const uint8_t *data, uint16_t length)
+        {
+            if ((length & SHADOW_TILE_LENGTH_MASK) > this->slot_size_)
+                return false;
+            memcpy(this->slots_ + size_t(tile) * this->slot_size_, data, length & SHADOW_TILE_LENGTH_MASK);
+            this->lengths_[tile] = length;
+            this->versions_[tile]++;
+            return true;
+        }
+    } // namespace picocalc
+} // namespace esphome
+
+#endif  // USE_LVGL
@@ -0,0 +1,69 @@
+#pragma once
+#include "esphome/core/defines.h"
+
+#ifdef USE_LVGL
+#include <cstddef>
+#include <cstdint>
+#include <lvgl.h>
+
+namespace esphome {
+namespace picocalc {
+
+static const uint8_t SHADOW_TILE = 32;
+// Tile length flags. Lossy tiles had colour LSBs dropped to fit their slot;
+// partial tiles still contain pixels that were never flushed.
+static const uint16_t SHADOW_TILE_LOSSY = 0x8000;
+static const uint16_t SHADOW_TILE_PARTIAL = 0x4000;
+static const uint16_t SHADOW_TILE_LENGTH_MASK = 0x3FFF;
+
+// Run-length compressed copy of what was last flushed to the panel, kept in
+// fixed-size slots of SHADOW_TILE x SHADOW_TILE pixels. A run byte below 0x80
+// is followed by a colour (low byte first, as LVGL hands it to the flush
+// callback) repeated byte + 1 times; from 0x80 up it is a hole of
+// (byte & 0x7F) + 1 pixels whose content is unknown. An empty tile is all hole.
+class ScreenShadow {
+    public:
+        bool init(uint16_t width, uint16_t height, uint16_t slot_size);
+        bool is_ready() const { return this->slots_ != nullptr; }
+
+        void patch(const lv_area_t &area, const lv_color_t *pixels);
+        void forget(uint16_t tile);
+        // Replaces a tile with encoded data, e.g. from a page snapshot.
+        bool store(uint16_t tile, const uint8_t *data, uint16_t length);
+        // Expands a complete tile into internal scratch memory that stays valid
+        // until the next call into the shadow; nullptr if it has holes.
+        const uint16_t *expand(uint16_t tile);
+
+        uint16_t tile_count() const { return this->cols_ * this->rows_; }
+        uint16_t slot_size() const { return this->slot_size_; }
+        lv_area_t tile_area(uint16_t tile) const;
+        // Encoded length with the SHADOW_TILE_* flags.
+        uint16_t tile_length(uint16_t tile) const { return this->lengths_[tile]; }
+        bool is_exact(uint16_t tile) const;
+        const uint8_t *tile_data(uint16_t tile) const { return this->slots_ + size_t(tile) * this->slot_size_; }
+        // Bumped every time the tile content changes.
+        uint32_t tile_version(uint16_t tile) const { return this->versions_[tile]; }
+        size_t storage_size() const;
+
+    protected:
+        void decode_(uint16_t tile, uint16_t width, uint16_t count);
+        uint16_t encode_(uint16_t width, uint16_t count, uint16_t mask, uint8_t *out, bool *partial) const;
+        void encode_tile_(uint16_t tile, uint16_t width, uint16_t count, bool lossy);
+
+        uint16_t width_{0};
+        uint16_t height_{0};
+        uint16_t cols_{0};
+        uint16_t rows_{0};
+        uint16_t slot_size_{0};
+        uint8_t *slots_{nullptr};
+        uint16_t *lengths_{nullptr};
+        uint32_t *versions_{nullptr};
+        uint16_t scratch_[SHADOW_TILE * SHADOW_TILE];
+        // One bit per pixel of scratch_, set where the pixel is unknown.
+        uint32_t holes_[SHADOW_TILE];
+};
+
+}  // namespace picocalc
+}  // namespace esphome
+
+#endif  // USE_LVGL
@@ -0,0 +1,103 @@
+#include "update_queue.h"
+
+#ifdef USE_LVGL
+
+#include <cstring>
+
+namespace esphome
+{
+    namespace picocalc
+    {
+        void UpdateQueue::enqueue(lv_obj_t *label, const char *fmt, va_list args)
+        {
+            char text[LABEL_TEXT_SIZE];
+            format_label_text(text, fmt, args);
+            this->stats_.enqueued++;
+
+            uint8_t slot = this->texts_.slot_for(label);
+            if (slot == LABEL_NO_SLOT)
+            {
+                // Out of slots: apply right away.
+                if (LabelTextCache::set_unmanaged(label, text))
+                    this->stats_.applied++;
+                else
+                    this->stats_.suppressed++;
+                return;
+            }
+
+            PendingText &pending = this->pending_[slot];
+            if (pending.has_pending)
+            {
+                // The older pending value is dropped unseen.
+                this->stats_.suppressed++;
+            }
+            else if (this->texts_.shows(slot, text))
+            {
+                this->stats_.suppressed++;
+                return;
+            }
+            else
+            {
+                pending.has_pending = true;
+                this->pending_count_++;
+            }
+            memcpy(pending.text, text, sizeof(text));
+        }
+
+        void UpdateQueue::apply()
+        {
+            if (this->pending_count_ == 0)
+                return;
+            uint32_t epoch = this->epoch_ + 1;
+            bool changed = false;
+            for (uint8_t slot = 0; slot < this->texts_.count(); slot++)
+            {
+                PendingText &pending = this->pending_[slot];
+                if (!pending.has_pending)
+                    continue;
+                pending.has_pending = false;
+                if (!this->texts_.set(slot, pending.text))
+                {
+                    this->stats_.suppressed++;
+                    continue;
+                }
+                pending.applied_epoch = epoch;
+                changed = true;
+                this->stats_.applied++;
+            }
+            this->pending_count_ = 0;
+            if (changed)
+                this->epoch_ = epoch;
+        }
+
+        void UpdateQueue::invalidate_since(uint32_t epoch) const
+        {
+            for (uint8_t slot = 0; slot < this->texts_.count(); slot++)
+            {
+                if (this->pending_[slot].applied_epoch <= epoch)
+                    continue;
+                // The old text may have been wider than the new one, so take the full row of the parent.
+                lv_obj_t *label = this->texts_.label(slot);
+                lv_obj_t *parent = lv_obj_get_parent(label);
+                if (parent == nullptr)
+                {
+                    lv_obj_invalidate(label);
+                    continue;
+                }
+                lv_area_t label_area, row;
+                lv_obj_get_coords(label, &label_area);
+                lv_obj_get_coords(parent, &row);
+                row.y1 = label_area.y1;
+                row.y2 = label_area.y2;
+                lv_obj_invalidate_area(parent, &row);
+            }
+        }
+
+        bool UpdateQueue::tracks(const lv_obj_t *label) const
+        {
+            return this->texts_.find(label) != LABEL_NO_SLOT;
+        }
+    } // namespace picocalc
+} // namespace esphome
+
+#endif  // USE_LVGL
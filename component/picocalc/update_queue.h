@@ -0,0 +1,56 @@
+#pragma once
+#include "esphome/core/defines.h"
+
+#ifdef USE_LVGL
+#include <cstdarg>
+#include <lvgl.h>
+#include "label_text.h"
+
+namespace esphome {
+namespace picocalc {
+
+// Queue state of one LabelTextCache slot. `text` holds the latest value
+// queued since the last frame.
+struct PendingText {
+    bool has_pending{false};
+    // UpdateQueue::epoch() when the slot's text last reached LVGL.
+    uint32_t applied_epoch{0};
+    char text[LABEL_TEXT_SIZE]{};
+};
+
+struct UpdateQueueStats {
+    uint32_t enqueued{0};
+    uint32_t applied{0};
+    // Updates that never reached LVGL: overwritten while pending, or equal to what is shown.
+    uint32_t suppressed{0};
+};
+
+class UpdateQueue {
+    public:
+        void enqueue(lv_obj_t *label, const char *fmt, va_list args);
+        // Pushes every pending change into LVGL; called once per frame.
+        void apply();
+        // Advances with every apply() that changed a label.
+        uint32_t epoch() const { return this->epoch_; }
+        // Redraws the rows of all labels changed after `epoch`, e.g. while their page was hidden.
+        void invalidate_since(uint32_t epoch) const;
+        // Whether `label` gets its text through this queue.
+        bool tracks(const lv_obj_t *label) const;
+
+        const UpdateQueueStats &stats() const { return this->stats_; }
+        const AllocStats &alloc_stats() const { return this->texts_.stats(); }
+        // The pending text array; the label buffers are accounted by LabelTextCache.
+        static constexpr size_t storage_size() { return PICOCALC_LABEL_SLOTS * sizeof(PendingText); }
+
+    protected:
+        LabelTextCache texts_;
+        PendingText pending_[PICOCALC_LABEL_SLOTS];
+        uint8_t pending_count_{0};
+        uint32_t epoch_{0};
+        UpdateQueueStats stats_{};
+};
+
+}  // namespace picocalc
+}  // namespace esphome
+
+#endif  // USE_LVGL
@@ -0,0 +1,95 @@
+#!/usr/bin/env python3
+"""Check picocalc input-to-photon latency against limits.
+
+Runs the host build of scripts/latency_host.yaml (or reads a saved log),
+collects the "Input latency" reports of the picocalc latency tracer and
+fails when any percentile is over its limit. SDL runs headless unless
+SDL_VIDEODRIVER is already set.
+
+Usage:
+  ./scripts/latency_check.py [--reports 3] [--max-p50 150] [--max-p99 300]
+  pico logs | ./scripts/latency_check.py --log -
+"""
+import argparse
+import os
+import re
+import subprocess
+import sys
+
+REPORT_LINE = re.compile(
+    r"Input latency: p50 ([\d.]+) ms, p95 ([\d.]+) ms, p99 ([\d.]+) ms \((\d+) events, (\d+) expired\)"
+)
+DEFAULT_CONFIG = os.path.join(os.path.dirname(os.path.abspath(__file__)), "latency_host.yaml")
+
+
+def collect(lines, wanted):
+    reports = []
+    for line in lines:
+        match = REPORT_LINE.search(line)
+        if not match:
+            continue
+        p50, p95, p99 = (float(match.group(i)) for i in (1, 2, 3))
+        events, expired = int(match.group(4)), int(match.group(5))
+        print(f"p50 {p50:.1f}ms  p95 {p95:.1f}ms  p99 {p99:.1f}ms  {events} events, {expired} expired")
+        # The first interval starts before LVGL is up; skip reports without presses.
+        if events:
+            reports.append((p50, p95, p99, events, expired))
+        if len(reports) >= wanted:
+            break
+    return reports
+
+
+def run_host(args):
+    env = dict(os.environ)
+    env.setdefault("SDL_VIDEODRIVER", "dummy")
+    process = subprocess.Popen(
+        [args.esphome, "run", args.config],
+        stdout=subprocess.PIPE,
+        stderr=subprocess.STDOUT,
+        text=True,
+        errors="replace",
+        env=env,
+    )
+    try:
+        return collect(process.stdout, args.reports)
+    finally:
+        process.terminate()
+        process.wait()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--config", default=DEFAULT_CONFIG, help="host yaml to build and run")
+    parser.add_argument("--esphome", default="esphome", help="esphome executable")
+    parser.add_argument("--log", help="read reports from a log file instead, - for stdin")
+    parser.add_argument("--reports", type=int, default=3, help="reports with presses to collect")
+    parser.add_argument("--max-p50", type=float, help="limit for p50 in ms")
+    parser.add_argument("--max-p95", type=float, help="limit for p95 in ms")
+    parser.add_argument("--max-p99", type=float, help="limit for p99 in ms")
+    parser.add_argument("--max-expired", type=int, default=0, help="presses per report allowed to expire")
+    args = parser.parse_args()
+
+    if args.log:
+        stream = sys.stdin if args.log == "-" else open(args.log, encoding="utf-8", errors="replace")
+        reports = collect(stream, args.reports)
+    else:
+        reports = run_host(args)
+    if not reports:
+        print("no latency reports with presses", file=sys.stderr)
+        return 2
+
+    failures = []
+    for index, name, limit in ((0, "p50", args.max_p50), (1, "p95", args.max_p95), (2, "p99", args.max_p99)):
+        worst = max(report[index] for report in reports)
+        if limit is not None and worst > limit:
+            failures.append(f"{name} {worst:.1f}ms over {limit:g}ms")
+    expired = max(report[4] for report in reports)
+    if expired > args.max_expired:
+        failures.append(f"{expired} presses expired")
+    for failure in failures:
+        print(f"FAIL: {failure}", file=sys.stderr)
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
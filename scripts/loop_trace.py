@@ -0,0 +1,81 @@
+#!/usr/bin/env python3
+"""Decode the loop traces that the picocalc component logs as "trace:" lines.
+
+Usage:
+  pico logs | ./scripts/loop_trace.py
+  ./scripts/loop_trace.py saved_log.txt
+"""
+import re
+import struct
+import sys
+
+TRACE_LINE = re.compile(r"trace:([0-9a-f]{4}):([0-9a-f]+)")
+NAME_SIZE = 12
+
+
+def parse(blob):
+    magic, version, slot_count, buckets, top_n, uptime_ms, threshold_us = struct.unpack_from(
+        "<4sBBBBII", blob, 0
+    )
+    if magic != b"PCLT" or version != 1:
+        raise ValueError(f"not a loop trace: {magic!r} v{version}")
+    offset = 16
+    slots = []
+    for _ in range(slot_count):
+        name = blob[offset:offset + NAME_SIZE].rstrip(b"\0").decode()
+        offset += NAME_SIZE
+        count, max_us, total_lo, total_hi = struct.unpack_from("<IIII", blob, offset)
+        offset += 16
+        hist = struct.unpack_from(f"<{buckets}I", blob, offset)
+        offset += 4 * buckets
+        slots.append((name, count, max_us, total_lo | (total_hi << 32), hist))
+    calls = []
+    for _ in range(top_n):
+        timestamp_ms, duration_us, slot = struct.unpack_from("<IIB", blob, offset)
+        offset += 9
+        if slot != 0xFF:
+            calls.append((timestamp_ms, duration_us, slots[slot][0]))
+    return uptime_ms, threshold_us, slots, calls
+
+
+def bucket_label(index):
+    if index == 0:
+        return "<1us"
+    low = 1 << (index - 1)
+    return f">={low}us" if low < 1000 else f">={low / 1000:g}ms"
+
+
+def report(blob):
+    uptime_ms, threshold_us, slots, calls = parse(blob)
+    print(f"== trace at {uptime_ms / 1000:.1f}s uptime, slow threshold {threshold_us}us ==")
+    for name, count, max_us, total_us, hist in slots:
+        avg = total_us / count if count else 0
+        print(f"{name}: {count} calls, avg {avg:.0f}us, max {max_us}us")
+        peak = max(hist) or 1
+        for index, value in enumerate(hist):
+            if value:
+                bar = "#" * max(1, 40 * value // peak)
+                print(f"  {bucket_label(index):>10} {value:8d} {bar}")
+    for timestamp_ms, duration_us, name in calls:
+        print(f"  slow {name}: {duration_us}us at {timestamp_ms}ms")
+
+
+def main():
+    stream = open(sys.argv[1], encoding="utf-8", errors="replace") if len(sys.argv) > 1 else sys.stdin
+    blob = bytearray()
+    for line in stream:
+        match = TRACE_LINE.search(line)
+        if not match:
+            continue
+        offset = int(match.group(1), 16)
+        if offset == 0 and blob:
+            report(bytes(blob))
+            blob = bytearray()
+        if offset == len(blob):
+            blob += bytes.fromhex(match.group(2))
+    if blob:
+        report(bytes(blob))
+
+
+if __name__ == "__main__":
+    main()
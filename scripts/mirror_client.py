@@ -0,0 +1,161 @@
+#!/usr/bin/env python3
+"""Stand-in viewer for the picocalc screen mirror.
+
+Connects to the mirror port, rebuilds the screen from the damaged tiles it
+receives and prints the bandwidth of every frame. The latest picture can be
+written as a PPM image, and a raw stream can be recorded and replayed.
+
+Usage:
+  ./scripts/mirror_client.py picocalc.local [--port 6063] [--ppm screen.ppm]
+  ./scripts/mirror_client.py picocalc.local --record stream.bin
+  ./scripts/mirror_client.py --replay stream.bin --ppm screen.ppm
+"""
+import argparse
+import socket
+import struct
+import sys
+import time
+
+MIRROR_TILE = 0x01
+MIRROR_FRAME = 0x02
+TILE_PARTIAL = 0x4000
+TILE_LOSSY = 0x8000
+LENGTH_MASK = 0x3FFF
+RUN_HOLE = 0x80
+
+
+class Stream:
+    def __init__(self, source, record=None):
+        self.source = source
+        self.record = record
+        self.buffer = bytearray()
+
+    def read(self, size):
+        while len(self.buffer) < size:
+            chunk = self.source(4096)
+            if not chunk:
+                raise EOFError
+            if self.record:
+                self.record.write(chunk)
+            self.buffer += chunk
+        data = bytes(self.buffer[:size])
+        del self.buffer[:size]
+        return data
+
+
+class Screen:
+    def __init__(self, width, height, tile):
+        self.width = width
+        self.height = height
+        self.tile = tile
+        self.cols = (width + tile - 1) // tile
+        self.pixels = [0] * (width * height)
+
+    def apply(self, index, runs):
+        x0 = (index % self.cols) * self.tile
+        y0 = (index // self.cols) * self.tile
+        w = min(self.tile, self.width - x0)
+        h = min(self.tile, self.height - y0)
+        pos = 0
+        i = 0
+        while i < len(runs) and pos < w * h:
+            run = runs[i]
+            if run & RUN_HOLE:
+                # Unknown on the device: keep what we had.
+                pos += (run & ~RUN_HOLE) + 1
+                i += 1
+                continue
+            color = runs[i + 1] | (runs[i + 2] << 8)
+            for _ in range(run + 1):
+                if pos >= w * h:
+                    break
+                self.pixels[(y0 + pos // w) * self.width + x0 + pos % w] = color
+                pos += 1
+            i += 3
+
+    def write_ppm(self, path, swap):
+        out = bytearray(f"P6 {self.width} {self.height} 255\n".encode())
+        for color in self.pixels:
+            if swap:
+                color = ((color & 0xFF) << 8) | (color >> 8)
+            out += bytes((((color >> 11) & 0x1F) * 255 // 31, ((color >> 5) & 0x3F) * 255 // 63, (color & 0x1F) * 255 // 31))
+        with open(path, "wb") as f:
+            f.write(out)
+
+
+def run(stream, args):
+    magic, version, tile, width, height = struct.unpack("<4sBBHH", stream.read(10))
+    if magic != b"PCSM" or version != 1:
+        raise ValueError(f"not a screen mirror: {magic!r} v{version}")
+    print(f"== {width}x{height} screen, {tile}px tiles ==")
+    screen = Screen(width, height, tile)
+    frame_bytes = 10
+    frame_tiles = lossy = partial = 0
+    total_bytes = 0
+    frames = 0
+    started = last_frame = time.monotonic()
+    while True:
+        kind = stream.read(1)[0]
+        if kind == MIRROR_TILE:
+            _frame, index, length = struct.unpack("<IHH", stream.read(8))
+            runs = stream.read(length & LENGTH_MASK)
+            screen.apply(index, runs)
+            frame_bytes += 9 + len(runs)
+            frame_tiles += 1
+            lossy += bool(length & TILE_LOSSY)
+            partial += bool(length & TILE_PARTIAL)
+        elif kind == MIRROR_FRAME:
+            frame, tiles = struct.unpack("<IH", stream.read(6))
+            frame_bytes += 7
+            total_bytes += frame_bytes
+            frames += 1
+            now = time.monotonic()
+            elapsed = max(now - started, 1e-6)
+            print(
+                f"frame {frame}: {frame_tiles} tiles ({lossy} lossy, {partial} partial), {frame_bytes} B, "
+                f"{1000 * (now - last_frame):.0f} ms since last, avg {total_bytes / frames:.0f} B/frame, "
+                f"{total_bytes / elapsed / 1000:.1f} kB/s"
+            )
+            if tiles != frame_tiles:
+                print(f"  device counted {tiles} tiles", file=sys.stderr)
+            if args.ppm:
+                screen.write_ppm(args.ppm, args.swap)
+            frame_bytes = 0
+            frame_tiles = lossy = partial = 0
+            last_frame = now
+        else:
+            raise ValueError(f"unknown message type {kind:#x}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("host", nargs="?")
+    parser.add_argument("--port", type=int, default=6063)
+    parser.add_argument("--ppm", help="write the reconstructed screen here after every frame")
+    parser.add_argument("--swap", action="store_true", help="colours are byte swapped (LV_COLOR_16_SWAP)")
+    parser.add_argument("--record", help="save the raw stream")
+    parser.add_argument("--replay", help="decode a recorded stream instead of connecting")
+    args = parser.parse_args()
+
+    if args.replay:
+        with open(args.replay, "rb") as f:
+            stream = Stream(f.read)
+            try:
+                run(stream, args)
+            except EOFError:
+                pass
+        return
+    if not args.host:
+        parser.error("host is required unless --replay is given")
+    record = open(args.record, "wb") if args.record else None
+    with socket.create_connection((args.host, args.port)) as sock:
+        try:
+            run(Stream(sock.recv, record), args)
+        except (EOFError, KeyboardInterrupt):
+            pass
+    if record:
+        record.close()
+
+
+if __name__ == "__main__":
+    main()